@@ -6,6 +6,11 @@ App::App(int argc, char* argv[])
 {
     app = this;
 
+    HeadlessSettings headlessSettings;
+    bool runHeadless = ParseCommandLine(argc, argv, headlessSettings);
+
+    // First in, last out: every other module may hand work to it
+    jobs = new ModuleJobs(this);
     window = new ModuleWindow(this);
     camera = new ModuleCamera(this);
     input = new ModuleInput(this);
@@ -16,6 +21,13 @@ App::App(int argc, char* argv[])
     fileSystem = new ModuleFileSystem(this);
     resources = new ModuleResources(this);
 
+    if (runHeadless)
+    {
+        headless = new ModuleHeadless(this, headlessSettings);
+        vsync = VSyncMode::OFF;
+    }
+
+    AddModule(jobs);
     AddModule(window);
     AddModule(camera);
     AddModule(input);
@@ -25,6 +37,10 @@ App::App(int argc, char* argv[])
     AddModule(scene);
     AddModule(editor);
     AddModule(renderer3D);
+
+    // Last so it sees each frame after the renderer is done with it
+    if (headless)
+        AddModule(headless);
 }
 
 App::~App()
@@ -49,7 +65,9 @@ bool App::Awake()
         ret = module->Awake();
     }
 
-    timer.Start();
+    // Modules are up, the window and its context exist now
+    SetVSync(vsync);
+    pacer.Reset();
 
     return ret;
 }
@@ -71,8 +89,8 @@ bool App::Start()
 
 void App::PrepareUpdate()
 {
-    dt = (float)timer.ReadMs() / 1000.0f;
-    timer.Start();
+    // Start to start, so the time spent waiting on the pacer or the swap counts in the frame it ended
+    dt = pacer.BeginFrame();
 }
 
 bool App::Update()
@@ -130,15 +148,31 @@ bool App::Update()
 
 void App::FinishUpdate()
 {
-    if (!vsync)
-    {
-        const float frameDelay = 1000.0f / maxFps;
+    // Benchmark runs go as fast as they can
+    if (IsHeadless())
+        return;
 
-        float frameTime = (float)timer.ReadMs();
+    if (vsync == VSyncMode::OFF)
+        pacer.WaitForDeadline(maxFps);
+}
 
-        if (frameTime < frameDelay)
-            SDL_Delay((Uint32)(frameDelay - frameTime));
+void App::SetVSync(VSyncMode mode)
+{
+    if (!IsHeadless())
+    {
+        GLContextLock lock(renderer3D->renderThread);
+        mode = pacer.ApplyVSync(mode);
     }
+
+    vsync = mode;
+
+    SDL_DisplayMode displayMode;
+    if (SDL_GetWindowDisplayMode(window->window, &displayMode) == 0 && displayMode.refresh_rate > 0)
+        refreshRate = displayMode.refresh_rate;
+
+    // With vsync the display sets the pace, jitter is measured against its refresh interval
+    if (vsync != VSyncMode::OFF)
+        pacer.SetTargetMs(1000.0f / refreshRate);
 }
 
 bool App::CleanUp()
@@ -161,21 +195,103 @@ void App::AddModule(Module* module, bool activate)
     modules.push_back(module);
 }
 
+bool App::ParseCommandLine(int argc, char* argv[], HeadlessSettings& settings)
+{
+    bool headlessFlag = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        auto readInt = [&](int minimum)
+            {
+                int value = atoi(argv[++i]);
+                return value < minimum ? minimum : value;
+            };
+
+        // Percentages on the command line, ratios in the settings
+        auto readRatio = [&]()
+            {
+                float value = (float)atof(argv[++i]) / 100.0f;
+                return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+            };
+
+        if (arg == "--headless")
+            headlessFlag = true;
+        else if (arg == "--frames" && hasValue)
+            settings.frames = readInt(1);
+        else if (arg == "--width" && hasValue)
+            settings.width = readInt(1);
+        else if (arg == "--height" && hasValue)
+            settings.height = readInt(1);
+        else if (arg == "--instances" && hasValue)
+            settings.instances = readInt(0);
+        else if (arg == "--timings" && hasValue)
+            settings.timingsPath = argv[++i];
+        else if (arg == "--screenshot" && hasValue)
+            settings.imagePath = argv[++i];
+        else if (arg == "--extraction-scaling")
+            settings.extractionScaling = true;
+        else if (arg == "--job-benchmark")
+            settings.jobBenchmark = true;
+        else if (arg == "--stress" && hasValue)
+        {
+            settings.stress.objects = readInt(1);
+            settings.stressScene = true;
+        }
+        else if (arg == "--stress-depth" && hasValue)
+            settings.stress.depth = readInt(1);
+        else if (arg == "--stress-branching" && hasValue)
+            settings.stress.branching = readInt(1);
+        else if (arg == "--stress-meshes" && hasValue)
+            settings.stress.meshRatio = readRatio();
+        else if (arg == "--stress-mesh-kinds" && hasValue)
+            settings.stress.meshKinds = readInt(1);
+        else if (arg == "--stress-textures" && hasValue)
+            settings.stress.textures = readInt(0);
+        else if (arg == "--stress-static" && hasValue)
+            settings.stress.staticRatio = readRatio();
+        else if (arg == "--stress-seed" && hasValue)
+            settings.stress.seed = readInt(0);
+        else if (arg == "--scale-benchmark")
+            settings.scaleBenchmark = true;
+        else if (arg == "--scale-max" && hasValue)
+            settings.scaleMaxObjects = readInt(1);
+        else if (arg == "--scale-timings" && hasValue)
+            settings.scaleTimingsPath = argv[++i];
+        else
+            LOG(LogType::LOG_WARNING, "Unknown command line argument: %s", arg.c_str());
+    }
+
+    return headlessFlag;
+}
+
 void App::Play()
 {
+    if (isPlaying)
+        return;
+
+    // Whatever happens while playing is undone on Stop
+    scene->TakeSnapshot();
+
     isPlaying = true;
     LOG(LogType::LOG_INFO, "Game started");
 }
 
 void App::Stop()
 {
+    if (!isPlaying)
+        return;
+
     isPlaying = false;
+    scene->RestoreSnapshot();
     LOG(LogType::LOG_INFO, "Game stopped");
-    SaveGameState();
 }
 
 void App::SaveGameState()
 {
-    // Implementa la lgica para guardar el estado del juego
-    LOG(LogType::LOG_INFO, "Game state saved");
+    // The scene as it is right now, playing or not
+    if (scene->SaveScene("Library/Scenes/GameState.scene"))
+        LOG(LogType::LOG_INFO, "Game state saved");
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 #include "Logger.h"
 #include "Module.h"
+#include "ModuleJobs.h"
 #include "ModuleWindow.h"
 #include "ModuleCamera.h"
 #include "ModuleInput.h"
@@ -10,8 +11,9 @@
 #include "ModuleImporter.h"
 #include "ModuleFileSystem.h"
 #include "ModuleResources.h"
+#include "ModuleHeadless.h"
 
-#include "Timer.h"
+#include "FramePacer.h"
 
 #include <list>
 
@@ -27,6 +29,9 @@ public:
     bool CleanUp();
 
     float GetDT() { return dt; }
+    bool IsHeadless() const { return headless != nullptr; }
+
+    void SetVSync(VSyncMode mode);
 
     void Play();
     void Stop();
@@ -34,11 +39,13 @@ public:
 
 private:
     void AddModule(Module* module, bool enable = true);
+    bool ParseCommandLine(int argc, char* argv[], HeadlessSettings& settings);
 
     void PrepareUpdate();
     void FinishUpdate();
 
 public:
+    ModuleJobs* jobs = nullptr;
     ModuleWindow* window = nullptr;
     ModuleCamera* camera = nullptr;
     ModuleInput* input = nullptr;
@@ -48,14 +55,16 @@ public:
     ModuleEditor* editor = nullptr;
     ModuleFileSystem* fileSystem = nullptr;
     ModuleResources* resources = nullptr;
+    ModuleHeadless* headless = nullptr;
 
     bool exit = false;
     int maxFps = 60;
-    bool vsync = true;
+    VSyncMode vsync = VSyncMode::ON;
+    FramePacer pacer;
 
 private:
-    Timer   timer;
     float   dt;
+    int     refreshRate = 60;
 
     std::list<Module*> modules;
 
@@ -8,10 +8,6 @@ Component::~Component()
 {
 }
 
-void Component::Update()
-{
-}
-
 void Component::OnEditor()
 {
 }
@@ -20,7 +20,7 @@ public:
 	Component(GameObject* owner, ComponentType type);
 	virtual ~Component();
 
-	virtual void Update();
+	// Per-frame work runs as systems over the scene's EntityRegistry, components only draw their inspector
 	virtual void OnEditor();
 
 	void Enable();
@@ -7,7 +7,7 @@
 #include <shellapi.h>
 #include <algorithm>
 
-ComponentMaterial::ComponentMaterial(GameObject* gameObject) : Component(gameObject, ComponentType::MATERIAL), materialTexture(nullptr), textureId(-1)
+ComponentMaterial::ComponentMaterial(GameObject* gameObject) : Component(gameObject, ComponentType::MATERIAL)
 {
 }
 
@@ -15,21 +15,23 @@ ComponentMaterial::~ComponentMaterial()
 {
 }
 
-void ComponentMaterial::Update()
-{
-}
-
 void ComponentMaterial::OnEditor()
 {
 	if (ImGui::CollapsingHeader("Material", ImGuiTreeNodeFlags_DefaultOpen))
 	{
-		if (materialTexture->textureId != -1)
+		MaterialData& data = app->scene->entities.GetMaterial(gameObject->entity);
+		Texture* materialTexture = data.texture;
+
+		if (materialTexture != nullptr && materialTexture->textureId != -1)
 		{
 			ImGui::Text("Path: %s", materialTexture->texturePath);
 			ImGui::Text("Texture Size: %i x %i", materialTexture->textureWidth, materialTexture->textureHeight);
 			ImGui::Image((ImTextureID)(uintptr_t)materialTexture->textureId, ImVec2(200, 200), ImVec2(0, 1), ImVec2(1, 0));
 
-			if (ImGui::MenuItem("Show in Explorer"))
+			// Generated textures only exist in memory, there is no file to show or open
+			const bool hasFile = !SceneGenerator::IsGeneratedTexture(materialTexture->texturePath);
+
+			if (hasFile && ImGui::MenuItem("Show in Explorer"))
 			{
 				char buffer[MAX_PATH];
 				GetModuleFileName(NULL, buffer, MAX_PATH);
@@ -44,7 +46,7 @@ void ComponentMaterial::OnEditor()
 				ShellExecute(NULL, "open", "explorer.exe", command.c_str(), NULL, SW_SHOWDEFAULT);
 			}
 
-			if (ImGui::MenuItem("Open Image"))
+			if (hasFile && ImGui::MenuItem("Open Image"))
 			{
 				char buffer[MAX_PATH];
 				GetModuleFileName(NULL, buffer, MAX_PATH);
@@ -56,35 +58,53 @@ void ComponentMaterial::OnEditor()
 				ShellExecute(NULL, "open", path.c_str(), NULL, NULL, SW_SHOWDEFAULT);
 			}
 
-			if (ImGui::Checkbox("Show Checkers Texture", &showCheckersTexture))
+			if (ImGui::Checkbox("Show Checkers Texture", &data.showCheckersTexture))
 			{
-				textureId = showCheckersTexture ? app->renderer3D->checkerTextureId : materialTexture->textureId;
+				data.textureId = data.showCheckersTexture ? app->renderer3D->checkerTextureId : materialTexture->textureId;
 			}
 		}
 	}
 }
 
-void ComponentMaterial::AddTexture(Texture* texture)
+void ComponentMaterial::AddTexture(GameObject* gameObject, Texture* texture)
 {
-	if (gameObject->GetComponent(ComponentType::MESH))
+	if (gameObject->mesh != nullptr)
 	{
-		if (!gameObject->GetComponent(ComponentType::MATERIAL))
-		{
-			gameObject->AddComponent(gameObject->material);
-		}
-
-		materialTexture = texture;
-		textureId = materialTexture->textureId;
+		gameObject->AddComponent(ComponentType::MATERIAL);
+		gameObject->material->SetTexture(texture);
 	}
 
 	for (auto& child : gameObject->children)
 	{
-		if (!child->GetComponent(ComponentType::MATERIAL))
-		{
-			child->AddComponent(child->material);
-		}
-
-		child->material->materialTexture = texture;
-		child->material->textureId = texture->textureId;
+		child->AddComponent(ComponentType::MATERIAL);
+		child->material->SetTexture(texture);
 	}
+}
+
+GLuint ComponentMaterial::GetTextureId(const GameObject* gameObject)
+{
+	return gameObject->material != nullptr ? gameObject->material->GetTextureId() : (GLuint)-1;
+}
+
+Texture* ComponentMaterial::GetTexture() const
+{
+	return app->scene->entities.GetMaterial(gameObject->entity).texture;
+}
+
+GLuint ComponentMaterial::GetTextureId() const
+{
+	return app->scene->entities.GetMaterial(gameObject->entity).textureId;
+}
+
+void ComponentMaterial::SetTexture(Texture* texture)
+{
+	MaterialData& data = app->scene->entities.GetMaterial(gameObject->entity);
+	data.texture = texture;
+	data.textureId = texture != nullptr ? texture->textureId : (GLuint)-1;
+	data.showCheckersTexture = false;
+}
+
+void ComponentMaterial::SetTextureId(GLuint textureId)
+{
+	app->scene->entities.GetMaterial(gameObject->entity).textureId = textureId;
 }
\ No newline at end of file
@@ -3,21 +3,22 @@
 #include "Component.h"
 #include "Texture.h"
 
+// Editor handle, the data is a MaterialData row in the scene's EntityRegistry
 class ComponentMaterial : public Component
 {
 public:
 	ComponentMaterial(GameObject* gameObject);
 	virtual ~ComponentMaterial();
 
-	void Update() override;
 	void OnEditor() override;
 
-	void AddTexture(Texture* texture);
+	// Gives the texture to the object if it has a mesh, and to its children, adding materials as needed
+	static void AddTexture(GameObject* gameObject, Texture* texture);
+	// -1 for objects without a material
+	static GLuint GetTextureId(const GameObject* gameObject);
 
-public:
-	Texture* materialTexture;
-	GLuint textureId;
-
-private:
-	bool showCheckersTexture = false;
+	Texture* GetTexture() const;
+	GLuint GetTextureId() const;
+	void SetTexture(Texture* texture);
+	void SetTextureId(GLuint textureId);
 };
\ No newline at end of file
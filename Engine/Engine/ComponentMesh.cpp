@@ -1,9 +1,7 @@
 #include "ComponentMesh.h"
 #include "App.h"
 
-#include <glm/gtc/type_ptr.hpp>
-
-ComponentMesh::ComponentMesh(GameObject* gameObject) : Component(gameObject, ComponentType::MESH), mesh(nullptr)
+ComponentMesh::ComponentMesh(GameObject* gameObject) : Component(gameObject, ComponentType::MESH)
 {
 }
 
@@ -11,75 +9,43 @@ ComponentMesh::~ComponentMesh()
 {
 }
 
-void ComponentMesh::Update()
+Mesh* ComponentMesh::GetMesh() const
 {
-    ComponentTransform* transform = gameObject->transform;
-
-    if (transform != nullptr)
-    {
-        // Log para verificar los valores de transformacin
-        LOG(LogType::LOG_INFO, "Applying transform to mesh - Position: (%f, %f, %f), Scale: (%f, %f, %f)",
-            transform->position.x, transform->position.y, transform->position.z,
-            transform->scale.x, transform->scale.y, transform->scale.z);
-
-        // Asegurarse de que la matriz est actualizada
-        if (transform->updateTransform)
-        {
-            transform->UpdateTransform();
-        }
-
-        // Guardar la matriz actual
-        glPushMatrix();
-
-        // Aplicar la transformacin global
-        glMultMatrixf(glm::value_ptr(transform->globalTransform));
-    }
+    return app->scene->entities.GetMesh(gameObject->entity).mesh;
+}
 
-    ComponentMaterial* material = gameObject->material;
-    if (material != nullptr && mesh != nullptr)
-    {
-        mesh->DrawMesh(
-            material->textureId,
-            app->editor->preferencesWindow->drawTextures,
-            app->editor->preferencesWindow->wireframe,
-            app->editor->preferencesWindow->shadedWireframe
-        );
+void ComponentMesh::SetMesh(Mesh* mesh)
+{
+    app->scene->entities.GetMesh(gameObject->entity).mesh = mesh;
+}
 
-        if (showVertexNormals || showFaceNormals)
-        {
-            mesh->DrawNormals(
-                showVertexNormals,
-                showFaceNormals,
-                app->editor->preferencesWindow->vertexNormalLength,
-                app->editor->preferencesWindow->faceNormalLength,
-                app->editor->preferencesWindow->vertexNormalColor,
-                app->editor->preferencesWindow->faceNormalColor
-            );
-        }
-    }
-    else
-    {
-        LOG(LogType::LOG_WARNING, "Mesh or Material is null!");
-    }
+bool ComponentMesh::IsInStaticBatch() const
+{
+    return app->scene->entities.GetMesh(gameObject->entity).inStaticBatch;
+}
 
-    if (transform != nullptr)
-    {
-        glPopMatrix();
-    }
+void ComponentMesh::SetInStaticBatch(bool inStaticBatch)
+{
+    app->scene->entities.GetMesh(gameObject->entity).inStaticBatch = inStaticBatch;
 }
 
 void ComponentMesh::OnEditor()
 {
 	if (ImGui::CollapsingHeader("Mesh Renderer", ImGuiTreeNodeFlags_DefaultOpen))
 	{
-		ImGui::Text("Vertices: %d", mesh->verticesCount);
-		ImGui::Text("Indices: %d", mesh->indicesCount);
-		ImGui::Text("Normals: %d", mesh->normalsCount);
-		ImGui::Text("Texture Coords: %d", mesh->texCoordsCount);
+		MeshData& data = app->scene->entities.GetMesh(gameObject->entity);
+
+		if (data.mesh != nullptr)
+		{
+			ImGui::Text("Vertices: %d", data.mesh->verticesCount);
+			ImGui::Text("Indices: %d", data.mesh->indicesCount);
+			ImGui::Text("Normals: %d", data.mesh->normalsCount);
+			ImGui::Text("Texture Coords: %d", data.mesh->texCoordsCount);
+		}
 
 		ImGui::Spacing();
 
-		ImGui::Checkbox("Vertex Normals", &showVertexNormals);
-		ImGui::Checkbox("Face Normals", &showFaceNormals);
+		ImGui::Checkbox("Vertex Normals", &data.showVertexNormals);
+		ImGui::Checkbox("Face Normals", &data.showFaceNormals);
 	}
 }
\ No newline at end of file
@@ -5,19 +5,19 @@
 
 class Mesh;
 
+// Editor handle, the data is a MeshData row in the scene's EntityRegistry. Only allocated while the
+// entity has the component, so the row is always there
 class ComponentMesh : public Component
 {
 public:
 	ComponentMesh(GameObject* gameObject);
 	virtual ~ComponentMesh();
 
-	void Update() override;
 	void OnEditor() override;
 
-public:
-	Mesh* mesh;
+	Mesh* GetMesh() const;
+	void SetMesh(Mesh* mesh);
 
-private:
-	bool showVertexNormals = false;
-	bool showFaceNormals = false;
+	bool IsInStaticBatch() const;
+	void SetInStaticBatch(bool inStaticBatch);
 };
\ No newline at end of file
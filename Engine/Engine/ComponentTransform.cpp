@@ -1,22 +1,17 @@
 #include "ComponentTransform.h"
 #include "GameObject.h"
+#include "App.h"
 
 ComponentTransform::ComponentTransform(GameObject* gameObject) : Component(gameObject, ComponentType::TRANSFORM)
 {
-    localTransform = glm::float4x4(1.0f);
-    globalTransform = glm::float4x4(1.0f);
-
-    Decompose(globalTransform, position, rotation, scale);
-
-    eulerRotation = eulerAngles(rotation);
+    // Parents are always constructed first, so their node exists
+    TransformId parent = gameObject->parent != nullptr ? gameObject->parent->transform->id : INVALID_TRANSFORM;
+    id = app->scene->transforms.Create(parent);
 }
 
 ComponentTransform::~ComponentTransform()
 {
-}
-
-void ComponentTransform::Update()
-{
+    app->scene->transforms.Destroy(id);
 }
 
 void ComponentTransform::OnEditor()
@@ -25,6 +20,13 @@ void ComponentTransform::OnEditor()
     {
         const char* labels[] = { "X", "Y", "Z" };
 
+        // Edited as copies and written back in one go
+        TransformHierarchy& transforms = app->scene->transforms;
+        glm::float3 position = transforms.GetPosition(id);
+        glm::float3 eulerRotation = transforms.GetEulerDegrees(id);
+        glm::float3 scale = transforms.GetScale(id);
+        bool updateTransform = false;
+
         // Position
         ImGui::AlignTextToFramePadding();
         ImGui::Text("Position      ");
@@ -128,89 +130,71 @@ void ComponentTransform::OnEditor()
             scale = glm::float3(1.f);
             updateTransform = true;
         }
-    }
 
-    if (updateTransform) UpdateTransform();
+        if (updateTransform)
+        {
+            transforms.SetLocalEuler(id, position, eulerRotation, scale);
+            OnLocalChanged(true);
+        }
+    }
 }
 
-void ComponentTransform::SetTransformMatrix(glm::float3 position, glm::quat rotation, glm::float3 scale, ComponentTransform* parent)
+void ComponentTransform::SetTransformMatrix(glm::float3 position, glm::quat rotation, glm::float3 scale)
 {
-    this->position = position;
-    this->rotation = rotation;
-    this->scale = scale;
-
-    eulerRotation = degrees(glm::eulerAngles(rotation));
-
-    localTransform = glm::float4x4(1.0f);
-    localTransform = glm::translate(localTransform, position);
-    localTransform *= glm::mat4_cast(rotation);
-    localTransform = glm::scale(localTransform, scale);
-
-    if (parent != nullptr)
-    {
-        globalTransform = parent->globalTransform * localTransform;
-    }
+    app->scene->transforms.SetLocal(id, position, rotation, scale);
+    OnLocalChanged(false);
 }
 
-void ComponentTransform::UpdateTransform()
+void ComponentTransform::SetMatrix(const glm::mat4& matrix)
 {
-    rotation = glm::quat(glm::vec3(glm::radians(eulerRotation.x), glm::radians(eulerRotation.y), glm::radians(eulerRotation.z)));
-
-    localTransform = glm::float4x4(1.0f);
-    localTransform = glm::translate(localTransform, position);
-    localTransform *= glm::mat4_cast(rotation);
-    localTransform = glm::scale(localTransform, scale);
-
-    if (gameObject->parent != nullptr)
-    {
-        ComponentTransform* parentTransform = gameObject->parent->transform;
-        globalTransform = parentTransform->globalTransform * localTransform;
-    }
-    else
-    {
-        globalTransform = localTransform;
-    }
-
-    for (auto child : gameObject->children)
-    {
-        child->transform->UpdateTransform();
-    }
+    app->scene->transforms.SetLocalMatrix(id, matrix);
+    OnLocalChanged(false);
+}
 
-    updateTransform = false;
+const glm::float4x4& ComponentTransform::GetLocalTransform() const
+{
+    return app->scene->transforms.GetLocal(id);
 }
 
-void ComponentTransform::SetMatrix(const glm::mat4& matrix)
+const glm::float4x4& ComponentTransform::GetGlobalTransform() const
 {
-    localTransform = matrix;
-    UpdateTransform();
+    return app->scene->transforms.GetWorld(id);
 }
 
-bool ComponentTransform::Decompose(const glm::float4x4& transform, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale)
+glm::float3 ComponentTransform::GetPosition() const
 {
-    glm::float4x4 localMatrix(transform);
+    return app->scene->transforms.GetPosition(id);
+}
 
-    translation = glm::vec3(localMatrix[3]);
+glm::quat ComponentTransform::GetRotation() const
+{
+    return app->scene->transforms.GetRotation(id);
+}
 
-    glm::vec3 row[3];
+glm::float3 ComponentTransform::GetScale() const
+{
+    return app->scene->transforms.GetScale(id);
+}
 
-    for (int i = 0; i < 3; i++)
+void ComponentTransform::OnLocalChanged(bool checkChildren)
+{
+    // Static geometry is baked into world space, moving it invalidates the batches. Looking for static
+    // children is left to interactive edits, loaders set every node of a subtree one by one
+    if (gameObject->isStatic || (checkChildren && HasStaticDescendant(gameObject)))
     {
-        row[i] = glm::vec3(localMatrix[i]);
+        app->renderer3D->staticBatcher.MarkDirty();
     }
+}
 
-    scale.x = glm::length(row[0]);
-    scale.y = glm::length(row[1]);
-    scale.z = glm::length(row[2]);
-
-    if (scale.x != 0) row[0] /= scale.x;
-    if (scale.y != 0) row[1] /= scale.y;
-    if (scale.z != 0) row[2] /= scale.z;
-
-    glm::mat3 rotationMatrix(row[0], row[1], row[2]);
-
-    rotation = glm::quat_cast(rotationMatrix);
+bool ComponentTransform::HasStaticDescendant(const GameObject* node)
+{
+    for (const GameObject* child : node->children)
+    {
+        if (child->isStatic || HasStaticDescendant(child))
+            return true;
+    }
 
-    return true;
+    return false;
 }
 
 void ComponentTransform::SetButtonColor(const char* label)
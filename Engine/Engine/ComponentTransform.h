@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Component.h"
+#include "TransformHierarchy.h"
 #include "glm/glm.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/euler_angles.hpp"
@@ -11,28 +12,26 @@ public:
     ComponentTransform(GameObject* gameObject);
     virtual ~ComponentTransform();
 
-    void Update() override;
     void OnEditor() override;
 
-    void SetTransformMatrix(glm::float3 position, glm::quat rotation, glm::float3 scale, ComponentTransform* parent);
-    void UpdateTransform();
+    void SetTransformMatrix(glm::float3 position, glm::quat rotation, glm::float3 scale);
     void SetMatrix(const glm::mat4& matrix);  // Agregar esta lnea
 
-    bool Decompose(const glm::float4x4& transform, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale);
+    // Views into the scene's TransformHierarchy, the world matrix is current as of its last Update
+    const glm::float4x4& GetLocalTransform() const;
+    const glm::float4x4& GetGlobalTransform() const;
+    glm::float3 GetPosition() const;
+    glm::quat GetRotation() const;
+    glm::float3 GetScale() const;
 
 private:
     void SetButtonColor(const char* label);
+    void OnLocalChanged(bool checkChildren);
+    static bool HasStaticDescendant(const GameObject* node);
 
 public:
-    glm::float4x4 localTransform;
-    glm::float4x4 globalTransform;
-
-    glm::float3 position;
-    glm::quat rotation;
-    glm::float3 eulerRotation;
-    glm::float3 scale;
+    TransformId id = INVALID_TRANSFORM;
 
     bool constrainedProportions = false;
     float initialScale[3] = { 1.0f, 1.0f, 1.0f };
-    bool updateTransform = false;
 };
\ No newline at end of file
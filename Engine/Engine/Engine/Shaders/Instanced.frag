@@ -0,0 +1,13 @@
+#version 330 core
+
+in vec2 fragTexCoord;
+
+uniform sampler2D diffuseTexture;
+uniform int hasTexture;
+
+out vec4 fragColor;
+
+void main()
+{
+	fragColor = hasTexture != 0 ? texture(diffuseTexture, fragTexCoord) : vec4(1.0);
+}
@@ -0,0 +1,16 @@
+#version 330 core
+
+layout(location = 0) in vec3 position;
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texCoord;
+layout(location = 4) in mat4 instanceTransform;
+
+uniform mat4 viewProjection;
+
+out vec2 fragTexCoord;
+
+void main()
+{
+	fragTexCoord = texCoord;
+	gl_Position = viewProjection * instanceTransform * vec4(position, 1.0);
+}
@@ -0,0 +1,217 @@
+#include "EntityRegistry.h"
+
+#define INVALID_ARCHETYPE 0xFFFFFFFFu
+
+EntityRegistry::EntityRegistry()
+{
+	// Archetype 0 is the empty one every entity starts in
+	archetypes.emplace_back();
+}
+
+EntityId EntityRegistry::Create(GameObject* owner, bool enabled)
+{
+	return Create(owner, enabled, 0);
+}
+
+EntityId EntityRegistry::Create(GameObject* owner, bool enabled, uint32_t mask)
+{
+	EntityId entity;
+	if (!freeIds.empty())
+	{
+		entity = freeIds.back();
+		freeIds.pop_back();
+	}
+	else
+	{
+		entity = (EntityId)records.size();
+		records.emplace_back();
+	}
+
+	const uint32_t archetypeIndex = FindArchetype(mask);
+	Archetype& archetype = archetypes[archetypeIndex];
+	records[entity].archetype = archetypeIndex;
+	records[entity].row = (uint32_t)archetype.entities.size();
+
+	archetype.entities.push_back(entity);
+	archetype.owners.push_back(owner);
+	archetype.enabled.push_back(enabled ? 1 : 0);
+
+	if (archetype.Has(ComponentType::TRANSFORM))
+		archetype.transforms.emplace_back();
+	if (archetype.Has(ComponentType::MESH))
+		archetype.meshes.emplace_back();
+	if (archetype.Has(ComponentType::MATERIAL))
+		archetype.materials.emplace_back();
+
+	++count;
+
+	return entity;
+}
+
+void EntityRegistry::Destroy(EntityId entity)
+{
+	EntityRecord& record = records[entity];
+	if (record.archetype == INVALID_ARCHETYPE)
+		return;
+
+	RemoveRow(record.archetype, record.row);
+	record.archetype = INVALID_ARCHETYPE;
+	freeIds.push_back(entity);
+
+	--count;
+}
+
+void EntityRegistry::Reserve(uint32_t mask, int count)
+{
+	if (count <= 0)
+		return;
+
+	Archetype& archetype = archetypes[FindArchetype(mask)];
+	const size_t size = archetype.entities.size() + count;
+
+	archetype.entities.reserve(size);
+	archetype.owners.reserve(size);
+	archetype.enabled.reserve(size);
+
+	if (archetype.Has(ComponentType::TRANSFORM))
+		archetype.transforms.reserve(size);
+	if (archetype.Has(ComponentType::MESH))
+		archetype.meshes.reserve(size);
+	if (archetype.Has(ComponentType::MATERIAL))
+		archetype.materials.reserve(size);
+
+	if (freeIds.size() < (size_t)count)
+		records.reserve(records.size() + count - freeIds.size());
+}
+
+void EntityRegistry::AddComponent(EntityId entity, ComponentType type)
+{
+	uint32_t mask = archetypes[records[entity].archetype].mask;
+	if (!(mask & COMPONENT_BIT(type)))
+		Move(entity, mask | COMPONENT_BIT(type));
+}
+
+void EntityRegistry::RemoveComponent(EntityId entity, ComponentType type)
+{
+	uint32_t mask = archetypes[records[entity].archetype].mask;
+	if (mask & COMPONENT_BIT(type))
+		Move(entity, mask & ~COMPONENT_BIT(type));
+}
+
+bool EntityRegistry::HasComponent(EntityId entity, ComponentType type) const
+{
+	return archetypes[records[entity].archetype].Has(type);
+}
+
+TransformData& EntityRegistry::GetTransform(EntityId entity)
+{
+	const EntityRecord& record = records[entity];
+	return archetypes[record.archetype].transforms[record.row];
+}
+
+MeshData& EntityRegistry::GetMesh(EntityId entity)
+{
+	const EntityRecord& record = records[entity];
+	return archetypes[record.archetype].meshes[record.row];
+}
+
+MaterialData& EntityRegistry::GetMaterial(EntityId entity)
+{
+	const EntityRecord& record = records[entity];
+	return archetypes[record.archetype].materials[record.row];
+}
+
+bool EntityRegistry::IsEnabled(EntityId entity) const
+{
+	const EntityRecord& record = records[entity];
+	return archetypes[record.archetype].enabled[record.row] != 0;
+}
+
+void EntityRegistry::SetEnabled(EntityId entity, bool enabled)
+{
+	const EntityRecord& record = records[entity];
+	archetypes[record.archetype].enabled[record.row] = enabled ? 1 : 0;
+}
+
+GameObject* EntityRegistry::GetOwner(EntityId entity) const
+{
+	const EntityRecord& record = records[entity];
+	return archetypes[record.archetype].owners[record.row];
+}
+
+uint32_t EntityRegistry::FindArchetype(uint32_t mask)
+{
+	// A handful of component combinations exist, a linear search is enough
+	for (uint32_t i = 0; i < (uint32_t)archetypes.size(); ++i)
+	{
+		if (archetypes[i].mask == mask)
+			return i;
+	}
+
+	archetypes.emplace_back();
+	archetypes.back().mask = mask;
+
+	return (uint32_t)archetypes.size() - 1;
+}
+
+void EntityRegistry::Move(EntityId entity, uint32_t mask)
+{
+	const EntityRecord record = records[entity];
+
+	// Looked up before taking references, it may add an archetype
+	const uint32_t target = FindArchetype(mask);
+
+	Archetype& from = archetypes[record.archetype];
+	Archetype& to = archetypes[target];
+	const uint32_t row = (uint32_t)to.entities.size();
+
+	to.entities.push_back(entity);
+	to.owners.push_back(from.owners[record.row]);
+	to.enabled.push_back(from.enabled[record.row]);
+
+	if (to.Has(ComponentType::TRANSFORM))
+		to.transforms.push_back(from.Has(ComponentType::TRANSFORM) ? from.transforms[record.row] : TransformData());
+	if (to.Has(ComponentType::MESH))
+		to.meshes.push_back(from.Has(ComponentType::MESH) ? from.meshes[record.row] : MeshData());
+	if (to.Has(ComponentType::MATERIAL))
+		to.materials.push_back(from.Has(ComponentType::MATERIAL) ? from.materials[record.row] : MaterialData());
+
+	RemoveRow(record.archetype, record.row);
+
+	records[entity].archetype = target;
+	records[entity].row = row;
+}
+
+void EntityRegistry::RemoveRow(uint32_t archetypeIndex, uint32_t row)
+{
+	Archetype& archetype = archetypes[archetypeIndex];
+	const uint32_t last = (uint32_t)archetype.entities.size() - 1;
+
+	// The last row fills the hole so the arrays stay packed
+	if (row != last)
+	{
+		archetype.entities[row] = archetype.entities[last];
+		archetype.owners[row] = archetype.owners[last];
+		archetype.enabled[row] = archetype.enabled[last];
+
+		if (archetype.Has(ComponentType::TRANSFORM))
+			archetype.transforms[row] = archetype.transforms[last];
+		if (archetype.Has(ComponentType::MESH))
+			archetype.meshes[row] = archetype.meshes[last];
+		if (archetype.Has(ComponentType::MATERIAL))
+			archetype.materials[row] = archetype.materials[last];
+
+		records[archetype.entities[row]].row = row;
+	}
+
+	archetype.entities.pop_back();
+	archetype.owners.pop_back();
+	archetype.enabled.pop_back();
+
+	if (archetype.Has(ComponentType::TRANSFORM))
+		archetype.transforms.pop_back();
+	if (archetype.Has(ComponentType::MESH))
+		archetype.meshes.pop_back();
+	if (archetype.Has(ComponentType::MATERIAL))
+		archetype.materials.pop_back();
+}
\ No newline at end of file
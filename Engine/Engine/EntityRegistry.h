@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Component.h"
+#include "TransformHierarchy.h"
+
+#include <cstdint>
+#include <vector>
+
+class GameObject;
+class Mesh;
+class Texture;
+
+typedef unsigned int GLuint;
+typedef uint32_t EntityId;
+
+#define INVALID_ENTITY 0xFFFFFFFFu
+#define COMPONENT_BIT(type) (1u << (uint32_t)(type))
+
+struct TransformData
+{
+	TransformId id = INVALID_TRANSFORM;
+};
+
+struct MeshData
+{
+	Mesh* mesh = nullptr;
+	bool inStaticBatch = false;
+	bool showVertexNormals = false;
+	bool showFaceNormals = false;
+};
+
+struct MaterialData
+{
+	Texture* texture = nullptr;
+	GLuint textureId = (GLuint)-1;
+	bool showCheckersTexture = false;
+};
+
+// Every entity with exactly the same components. Rows line up across the arrays, and only the arrays
+// of components in the mask are used
+struct Archetype
+{
+	uint32_t mask = 0;
+
+	std::vector<EntityId> entities;
+	std::vector<GameObject*> owners;
+	// Active itself and all of its ancestors
+	std::vector<uint8_t> enabled;
+
+	std::vector<TransformData> transforms;
+	std::vector<MeshData> meshes;
+	std::vector<MaterialData> materials;
+
+	bool Has(ComponentType type) const { return (mask & COMPONENT_BIT(type)) != 0; }
+	size_t Size() const { return entities.size(); }
+};
+
+// Component data of every GameObject, grouped by archetype so systems walk plain arrays of the entities
+// that have what they need instead of asking each object. Adding or removing a component moves the
+// entity to another archetype, so references into the arrays only hold until the next change
+class EntityRegistry
+{
+public:
+	EntityRegistry();
+
+	EntityId Create(GameObject* owner, bool enabled);
+	// Straight into the archetype of mask with its data at the defaults, without moving through the
+	// archetypes in between like adding the components one by one does
+	EntityId Create(GameObject* owner, bool enabled, uint32_t mask);
+	void Destroy(EntityId entity);
+
+	// Room for count more entities with exactly the components in mask, for loaders that know the counts
+	void Reserve(uint32_t mask, int count);
+
+	// Adding one that is there already does nothing, new data starts at its defaults
+	void AddComponent(EntityId entity, ComponentType type);
+	void RemoveComponent(EntityId entity, ComponentType type);
+	bool HasComponent(EntityId entity, ComponentType type) const;
+
+	// The component has to be there
+	TransformData& GetTransform(EntityId entity);
+	MeshData& GetMesh(EntityId entity);
+	MaterialData& GetMaterial(EntityId entity);
+
+	bool IsEnabled(EntityId entity) const;
+	void SetEnabled(EntityId entity, bool enabled);
+	GameObject* GetOwner(EntityId entity) const;
+
+	// Calls function on every non-empty archetype holding at least the components in mask. It must
+	// not add or remove entities or components
+	template <typename Function>
+	void ForEach(uint32_t mask, Function function)
+	{
+		for (Archetype& archetype : archetypes)
+		{
+			if ((archetype.mask & mask) == mask && !archetype.entities.empty())
+				function(archetype);
+		}
+	}
+
+	int GetCount() const { return count; }
+	int GetArchetypeCount() const { return (int)archetypes.size(); }
+
+private:
+	struct EntityRecord
+	{
+		uint32_t archetype = 0;
+		uint32_t row = 0;
+	};
+
+	uint32_t FindArchetype(uint32_t mask);
+	void Move(EntityId entity, uint32_t mask);
+	void RemoveRow(uint32_t archetypeIndex, uint32_t row);
+
+private:
+	// Indexed by entity
+	std::vector<EntityRecord> records;
+	std::vector<EntityId> freeIds;
+
+	std::vector<Archetype> archetypes;
+	int count = 0;
+};
\ No newline at end of file
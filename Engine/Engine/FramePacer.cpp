@@ -0,0 +1,139 @@
+#include "FramePacer.h"
+#include "Logger.h"
+
+#include <cmath>
+#include <thread>
+
+FramePacer::FramePacer()
+{
+	Reset();
+}
+
+void FramePacer::Reset()
+{
+	frequency = SDL_GetPerformanceFrequency();
+	lastFrameStart = SDL_GetPerformanceCounter();
+	nextDeadline = lastFrameStart;
+	period = 0;
+}
+
+float FramePacer::BeginFrame()
+{
+	Uint64 now = SDL_GetPerformanceCounter();
+	float frameMs = (float)ToMs(now - lastFrameStart);
+	lastFrameStart = now;
+
+	history[historyOffset] = frameMs;
+	historyOffset = (historyOffset + 1) % FRAME_PACER_HISTORY;
+	if (samples < FRAME_PACER_HISTORY)
+		++samples;
+
+	UpdateStats();
+
+	return frameMs / 1000.0f;
+}
+
+void FramePacer::WaitForDeadline(int maxFps)
+{
+	if (maxFps <= 0)
+		return;
+
+	Uint64 now = SDL_GetPerformanceCounter();
+	Uint64 newPeriod = frequency / (Uint64)maxFps;
+
+	// A new rate starts a new schedule
+	if (newPeriod != period)
+	{
+		period = newPeriod;
+		nextDeadline = now;
+	}
+
+	stats.targetMs = (float)ToMs(period);
+	nextDeadline += period;
+
+	// More than a whole period late: realign instead of rushing the following frames to catch up
+	if (now > nextDeadline)
+	{
+		if (now - nextDeadline > period)
+		{
+			++stats.missedDeadlines;
+			nextDeadline = now;
+		}
+		return;
+	}
+
+	const Uint64 spinTicks = (Uint64)(spinMs * frequency / 1000.0f);
+
+	while (nextDeadline - now > spinTicks)
+	{
+		// SDL_Delay truncates to whole milliseconds, leaving the spin margin untouched
+		Uint32 sleepMs = (Uint32)ToMs(nextDeadline - now - spinTicks);
+		if (sleepMs == 0)
+			break;
+
+		SDL_Delay(sleepMs);
+		now = SDL_GetPerformanceCounter();
+
+		if (now >= nextDeadline)
+			break;
+	}
+
+	while (now < nextDeadline)
+	{
+		std::this_thread::yield();
+		now = SDL_GetPerformanceCounter();
+	}
+
+	stats.overshootMs = stats.overshootMs * 0.9f + (float)ToMs(now - nextDeadline) * 0.1f;
+}
+
+VSyncMode FramePacer::ApplyVSync(VSyncMode mode)
+{
+	switch (mode)
+	{
+	case VSyncMode::ADAPTIVE:
+		if (SDL_GL_SetSwapInterval(-1) == 0)
+			break;
+
+		LOG(LogType::LOG_WARNING, "Adaptive VSync not supported, using regular VSync: %s", SDL_GetError());
+		mode = VSyncMode::ON;
+		// fall through
+	case VSyncMode::ON:
+		SDL_GL_SetSwapInterval(1);
+		break;
+	case VSyncMode::OFF:
+		SDL_GL_SetSwapInterval(0);
+		break;
+	}
+
+	// The limiter schedule restarts when it takes over from the display again
+	period = 0;
+
+	return mode;
+}
+
+void FramePacer::UpdateStats()
+{
+	double sum = 0.0;
+	for (int i = 0; i < samples; ++i)
+		sum += history[i];
+
+	double mean = sum / samples;
+	double variance = 0.0;
+	float maxDeviation = 0.0f;
+	float reference = stats.targetMs > 0.0f ? stats.targetMs : (float)mean;
+
+	for (int i = 0; i < samples; ++i)
+	{
+		double delta = history[i] - mean;
+		variance += delta * delta;
+
+		float deviation = std::fabs(history[i] - reference);
+		if (deviation > maxDeviation)
+			maxDeviation = deviation;
+	}
+
+	stats.avgMs = (float)mean;
+	stats.jitterMs = (float)std::sqrt(variance / samples);
+	stats.maxDeviationMs = maxDeviation;
+}
\ No newline at end of file
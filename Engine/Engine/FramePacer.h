@@ -0,0 +1,68 @@
+#pragma once
+
+#include "SDL2/SDL.h"
+
+#define FRAME_PACER_HISTORY 120
+
+enum class VSyncMode
+{
+	OFF,
+	ON,
+	ADAPTIVE
+};
+
+struct FramePacingStats
+{
+	float targetMs = 0.0f;
+	float avgMs = 0.0f;
+	float jitterMs = 0.0f;
+	float maxDeviationMs = 0.0f;
+	float overshootMs = 0.0f;
+	int missedDeadlines = 0;
+};
+
+// Frame limiter on an absolute schedule: each deadline is the previous one plus the period, so
+// wake-up errors do not accumulate. Sleeps coarsely, then spins the last stretch for precision
+class FramePacer
+{
+public:
+	FramePacer();
+
+	void Reset();
+
+	// Called at the start of a frame, returns the seconds since the previous frame started
+	float BeginFrame();
+
+	// Blocks until the next deadline for the given frame rate
+	void WaitForDeadline(int maxFps);
+
+	// Adaptive tears instead of stalling when a frame is late, falls back to regular vsync if unsupported
+	VSyncMode ApplyVSync(VSyncMode mode);
+
+	// Target used for the jitter stats when the display paces the frames
+	void SetTargetMs(float targetMs) { stats.targetMs = targetMs; }
+
+	const FramePacingStats& GetStats() const { return stats; }
+	const float* GetHistory() const { return history; }
+	int GetHistoryOffset() const { return historyOffset; }
+
+public:
+	// Remaining time below which the pacer stops sleeping and spins, covers the OS sleep granularity
+	float spinMs = 2.0f;
+
+private:
+	double ToMs(Uint64 ticks) const { return (double)ticks * 1000.0 / frequency; }
+	void UpdateStats();
+
+private:
+	Uint64 frequency = 1;
+	Uint64 lastFrameStart = 0;
+	Uint64 nextDeadline = 0;
+	Uint64 period = 0;
+
+	float history[FRAME_PACER_HISTORY] = {};
+	int historyOffset = 0;
+	int samples = 0;
+
+	FramePacingStats stats;
+};
\ No newline at end of file
@@ -0,0 +1,61 @@
+#include "Frustum.h"
+
+Frustum::Frustum()
+{
+	for (int i = 0; i < 6; ++i)
+		planes[i] = glm::vec4(0.0f);
+}
+
+void Frustum::Update(const glm::mat4& viewProjection)
+{
+	// Gribb-Hartmann extraction, glm matrices are column major
+	glm::vec4 row0(viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]);
+	glm::vec4 row1(viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]);
+	glm::vec4 row2(viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]);
+	glm::vec4 row3(viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]);
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row3 + row2;
+	planes[5] = row3 - row2;
+
+	for (int i = 0; i < 6; ++i)
+	{
+		float length = glm::length(glm::vec3(planes[i]));
+		if (length > 0.0f)
+			planes[i] /= length;
+	}
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		// Test the corner furthest along the plane normal
+		glm::vec3 positive(
+			planes[i].x >= 0.0f ? max.x : min.x,
+			planes[i].y >= 0.0f ? max.y : min.y,
+			planes[i].z >= 0.0f ? max.z : min.z
+		);
+
+		if (glm::dot(glm::vec3(planes[i]), positive) + planes[i].w < 0.0f)
+			return false;
+	}
+
+	return true;
+}
+
+bool Frustum::IntersectsAABB(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform) const
+{
+	// Re-fit the local box around its transformed extents (Arvo)
+	glm::vec3 center = glm::vec3(transform * glm::vec4((min + max) * 0.5f, 1.0f));
+	glm::vec3 localExtents = (max - min) * 0.5f;
+
+	glm::vec3 extents(0.0f);
+	for (int i = 0; i < 3; ++i)
+		extents += glm::abs(glm::vec3(transform[i])) * localExtents[i];
+
+	return IntersectsAABB(center - extents, center + extents);
+}
\ No newline at end of file
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <cstdint>
+
+enum class CullResult : uint8_t
+{
+	VISIBLE,
+	OUTSIDE_FRUSTUM,
+	OCCLUDED
+};
+
+class Frustum
+{
+public:
+	Frustum();
+
+	void Update(const glm::mat4& viewProjection);
+	bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max) const;
+	bool IntersectsAABB(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform) const;
+
+public:
+	// Left, right, bottom, top, near, far. xyz is the inward normal, w the distance
+	glm::vec4 planes[6];
+};
\ No newline at end of file
@@ -0,0 +1,181 @@
+#include "GLStateCache.h"
+
+GLStateCache::GLStateCache()
+{
+	Invalidate();
+}
+
+void GLStateCache::BeginFrame()
+{
+	Invalidate();
+
+	issuedCalls = 0;
+	skippedCalls = 0;
+}
+
+void GLStateCache::EndFrame()
+{
+	lastFrameIssued = issuedCalls;
+	lastFrameSkipped = skippedCalls;
+}
+
+void GLStateCache::Invalidate()
+{
+	for (int i = 0; i < GL_STATE_BUFFER_TARGETS; ++i)
+		buffers[i] = -1;
+
+	for (int i = 0; i < GL_STATE_CAPABILITIES; ++i)
+		capabilities[i] = -1;
+
+	for (int i = 0; i < GL_STATE_CLIENT_ARRAYS; ++i)
+		clientArrays[i] = -1;
+
+	for (int i = 0; i < GL_STATE_ATTRIBUTES; ++i)
+		attributes[i] = -1;
+
+	texture = -1;
+	program = -1;
+	polygonMode = -1;
+
+	InvalidateVertexLayout();
+}
+
+void GLStateCache::BindBuffer(GLenum target, GLuint buffer)
+{
+	int slot = BufferSlot(target);
+
+	if (slot < 0 || Track(buffers[slot], buffer))
+		glBindBuffer(target, buffer);
+}
+
+void GLStateCache::BindTexture(GLuint texture)
+{
+	if (Track(this->texture, texture))
+		glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLStateCache::UseProgram(GLuint program)
+{
+	if (Track(this->program, program))
+		glUseProgram(program);
+}
+
+void GLStateCache::PolygonMode(GLenum mode)
+{
+	if (Track(polygonMode, mode))
+		glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void GLStateCache::SetEnabled(GLenum capability, bool enabled)
+{
+	int slot = CapabilitySlot(capability);
+
+	if (slot >= 0 && !Track(capabilities[slot], enabled ? 1 : 0))
+		return;
+
+	if (slot < 0)
+		++issuedCalls;
+
+	if (enabled)
+		glEnable(capability);
+	else
+		glDisable(capability);
+}
+
+void GLStateCache::SetClientState(GLenum array, bool enabled)
+{
+	int slot = ClientArraySlot(array);
+
+	if (slot >= 0 && !Track(clientArrays[slot], enabled ? 1 : 0))
+		return;
+
+	if (slot < 0)
+		++issuedCalls;
+
+	if (enabled)
+		glEnableClientState(array);
+	else
+		glDisableClientState(array);
+}
+
+void GLStateCache::SetVertexAttribArray(GLuint index, bool enabled)
+{
+	if (index < GL_STATE_ATTRIBUTES && !Track(attributes[index], enabled ? 1 : 0))
+		return;
+
+	if (index >= GL_STATE_ATTRIBUTES)
+		++issuedCalls;
+
+	if (enabled)
+		glEnableVertexAttribArray(index);
+	else
+		glDisableVertexAttribArray(index);
+}
+
+bool GLStateCache::SetVertexLayout(const void* owner, unsigned int layout)
+{
+	if (enabled && layoutOwner == owner && this->layout == layout)
+	{
+		++skippedCalls;
+		return false;
+	}
+
+	layoutOwner = owner;
+	this->layout = layout;
+	++issuedCalls;
+	return true;
+}
+
+void GLStateCache::InvalidateVertexLayout()
+{
+	layoutOwner = nullptr;
+	layout = 0;
+}
+
+bool GLStateCache::Track(int64_t& shadow, int64_t value)
+{
+	if (enabled && shadow == value)
+	{
+		++skippedCalls;
+		return false;
+	}
+
+	shadow = value;
+	++issuedCalls;
+	return true;
+}
+
+int GLStateCache::BufferSlot(GLenum target) const
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER: return 0;
+	case GL_ELEMENT_ARRAY_BUFFER: return 1;
+	case GL_DRAW_INDIRECT_BUFFER: return 2;
+	default: return -1;
+	}
+}
+
+int GLStateCache::CapabilitySlot(GLenum capability) const
+{
+	switch (capability)
+	{
+	case GL_CULL_FACE: return 0;
+	case GL_TEXTURE_2D: return 1;
+	case GL_LIGHTING: return 2;
+	case GL_BLEND: return 3;
+	case GL_DEPTH_TEST: return 4;
+	default: return -1;
+	}
+}
+
+int GLStateCache::ClientArraySlot(GLenum array) const
+{
+	switch (array)
+	{
+	case GL_VERTEX_ARRAY: return 0;
+	case GL_NORMAL_ARRAY: return 1;
+	case GL_TEXTURE_COORD_ARRAY: return 2;
+	default: return -1;
+	}
+}
\ No newline at end of file
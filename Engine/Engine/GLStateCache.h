@@ -0,0 +1,62 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+
+#define GL_STATE_BUFFER_TARGETS 3
+#define GL_STATE_CAPABILITIES 5
+#define GL_STATE_CLIENT_ARRAYS 3
+#define GL_STATE_ATTRIBUTES 8
+
+// Shadows the GL state the scene pass touches and drops calls that would not change it.
+// Invalidated at the start of every scene pass, so code outside the pass may keep calling GL directly
+class GLStateCache
+{
+public:
+	GLStateCache();
+
+	void BeginFrame();
+	void EndFrame();
+	void Invalidate();
+
+	void BindBuffer(GLenum target, GLuint buffer);
+	void BindTexture(GLuint texture);
+	void UseProgram(GLuint program);
+	void PolygonMode(GLenum mode);
+
+	void SetEnabled(GLenum capability, bool enabled);
+	void SetClientState(GLenum array, bool enabled);
+	void SetVertexAttribArray(GLuint index, bool enabled);
+
+	// True when the caller has to set its attribute pointers again
+	bool SetVertexLayout(const void* owner, unsigned int layout);
+	void InvalidateVertexLayout();
+
+public:
+	// When disabled every call is forwarded to GL, useful to measure the difference
+	bool enabled = true;
+
+	int issuedCalls = 0;
+	int skippedCalls = 0;
+	int lastFrameIssued = 0;
+	int lastFrameSkipped = 0;
+
+private:
+	bool Track(int64_t& shadow, int64_t value);
+	int BufferSlot(GLenum target) const;
+	int CapabilitySlot(GLenum capability) const;
+	int ClientArraySlot(GLenum array) const;
+
+private:
+	// -1 means unknown, the next call is always issued
+	int64_t buffers[GL_STATE_BUFFER_TARGETS];
+	int64_t texture;
+	int64_t program;
+	int64_t polygonMode;
+	int64_t capabilities[GL_STATE_CAPABILITIES];
+	int64_t clientArrays[GL_STATE_CLIENT_ARRAYS];
+	int64_t attributes[GL_STATE_ATTRIBUTES];
+
+	const void* layoutOwner = nullptr;
+	unsigned int layout = 0;
+};
\ No newline at end of file
@@ -2,33 +2,39 @@
 #include "ComponentTransform.h"
 #include "ComponentMesh.h"
 #include "ComponentMaterial.h"
+#include "App.h"
 
-GameObject::GameObject(const char* name, GameObject* parent) : parent(parent), name(name), transform(nullptr), mesh(nullptr), material(nullptr)
+GameObject::GameObject(const char* name, GameObject* parent) : GameObject(name, parent, 0)
 {
-    transform = new ComponentTransform(this);
-    mesh = new ComponentMesh(this);
-    material = new ComponentMaterial(this);
-
-    AddComponent(transform);
 }
 
-GameObject::~GameObject()
+GameObject::GameObject(const char* name, GameObject* parent, uint32_t components) : parent(parent), name(name), transform(nullptr), mesh(nullptr), material(nullptr)
 {
+    ModuleScene* scene = app->scene;
+    EntityRegistry& entities = scene->entities;
+
+    // The entity starts in its final archetype, the components only need their objects
+    components |= COMPONENT_BIT(ComponentType::TRANSFORM);
+    entity = entities.Create(this, parent == nullptr || entities.IsEnabled(parent->entity), components);
+
+    transform = scene->transformComponents.Create(this);
+    entities.GetTransform(entity).id = transform->id;
+
+    if (components & COMPONENT_BIT(ComponentType::MESH))
+        mesh = scene->meshComponents.Create(this);
+    if (components & COMPONENT_BIT(ComponentType::MATERIAL))
+        material = scene->materialComponents.Create(this);
 }
 
-void GameObject::Update()
+GameObject::~GameObject()
 {
-    if (isActive)
-    {
-        for (std::vector<Component*>::iterator it = components.begin(); it != components.end(); ++it)
-        {
-            (*it)->Update();
-        }
-        for (std::vector<GameObject*>::iterator it = children.begin(); it != children.end(); ++it)
-        {
-            (*it)->Update();
-        }
-    }
+    ModuleScene* scene = app->scene;
+
+    scene->transformComponents.Destroy(transform);
+    scene->meshComponents.Destroy(mesh);
+    scene->materialComponents.Destroy(material);
+
+    scene->entities.Destroy(entity);
 }
 
 void GameObject::Enable()
@@ -39,20 +45,67 @@ void GameObject::Disable()
 {
 }
 
-Component* GameObject::AddComponent(Component* component)
+void GameObject::SetActive(bool active)
+{
+    isActive = active;
+    RefreshEnabled(parent == nullptr || app->scene->entities.IsEnabled(parent->entity));
+}
+
+void GameObject::SetName(const std::string& name)
+{
+    this->name = name;
+    app->scene->names.Rename(app->scene->GetHandle(this), name);
+}
+
+void GameObject::RefreshEnabled(bool parentEnabled)
+{
+    bool enabled = parentEnabled && isActive;
+    app->scene->entities.SetEnabled(entity, enabled);
+
+    for (auto child : children)
+    {
+        child->RefreshEnabled(enabled);
+    }
+}
+
+Component* GameObject::AddComponent(ComponentType type)
 {
-    components.push_back(component);
-    return component;
+    if (Component* component = GetComponent(type))
+        return component;
+
+    ModuleScene* scene = app->scene;
+
+    switch (type)
+    {
+    case ComponentType::TRANSFORM:
+        transform = scene->transformComponents.Create(this);
+        scene->entities.AddComponent(entity, type);
+        scene->entities.GetTransform(entity).id = transform->id;
+        break;
+    case ComponentType::MESH:
+        mesh = scene->meshComponents.Create(this);
+        scene->entities.AddComponent(entity, type);
+        break;
+    case ComponentType::MATERIAL:
+        material = scene->materialComponents.Create(this);
+        scene->entities.AddComponent(entity, type);
+        break;
+    default:
+        break;
+    }
+
+    return GetComponent(type);
 }
 
-Component* GameObject::GetComponent(ComponentType type)
+Component* GameObject::GetComponent(ComponentType type) const
 {
-    for (auto it = components.begin(); it != components.end(); ++it) {
-        if ((*it)->type == type) {
-            return (*it);
-        }
+    switch (type)
+    {
+    case ComponentType::TRANSFORM: return transform;
+    case ComponentType::MESH: return mesh;
+    case ComponentType::MATERIAL: return material;
+    default: return nullptr;
     }
-    return nullptr;
 }
 
 void GameObject::SetTransform(const glm::mat4& transform)
@@ -60,4 +113,14 @@ void GameObject::SetTransform(const glm::mat4& transform)
     if (this->transform != nullptr) {
         this->transform->SetMatrix(transform);
     }
+}
+
+void GameObject::SetStatic(bool isStatic)
+{
+    this->isStatic = isStatic;
+
+    for (auto child : children)
+    {
+        child->SetStatic(isStatic);
+    }
 }
\ No newline at end of file
@@ -4,34 +4,59 @@
 #include "ComponentTransform.h"
 #include "ComponentMesh.h"
 #include "ComponentMaterial.h"
+#include "EntityRegistry.h"
+#include "ObjectPool.h"
 
 #include <string>
 #include <vector>
 
+// Scene objects live in the scene's pool, anything that may outlive one keeps a handle instead of a pointer
+typedef PoolHandle GameObjectHandle;
+
 class GameObject
 {
 public:
     GameObject(const char* name, GameObject* parent);
+    // components holds the COMPONENT_BIT of every component to add besides the transform
+    GameObject(const char* name, GameObject* parent, uint32_t components);
     virtual ~GameObject();
 
-    void Update();
     void Enable();
     void Disable();
-    Component* AddComponent(Component* component);
-    Component* GetComponent(ComponentType type);
+    // Also enables or disables the children as far as systems are concerned
+    void SetActive(bool active);
+    // Keeps the scene's name index up to date, name itself is read-only outside of this
+    void SetName(const std::string& name);
+    // Allocates the component the first time, returns the existing one after that
+    Component* AddComponent(ComponentType type);
+    // Null unless the component was added
+    Component* GetComponent(ComponentType type) const;
     void SetTransform(const glm::mat4& transform);
+    void SetStatic(bool isStatic);
 
 public:
+    // Owning links, plain pointers on purpose: destroying an object unlinks it from its parent and takes
+    // its whole subtree with it, so a live object never points at a dead parent or child
     GameObject* parent;
     std::string name;
 
+    // Null until added, the transform is added on creation. Owned, released with the object
     ComponentTransform* transform;
     ComponentMesh* mesh;
     ComponentMaterial* material;
 
-    std::vector<Component*> components;
+    EntityId entity = INVALID_ENTITY;
+
     std::vector<GameObject*> children;
 
     bool isActive = true;
     bool isEditing = false;
+    // Open in the hierarchy window
+    bool isExpanded = false;
+
+    // Static objects never move and can be merged into static batches by the renderer
+    bool isStatic = false;
+
+private:
+    void RefreshEnabled(bool parentEnabled);
 };
\ No newline at end of file
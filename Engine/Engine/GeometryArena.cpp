@@ -0,0 +1,291 @@
+#include "GeometryArena.h"
+#include "Logger.h"
+
+#include <algorithm>
+
+namespace
+{
+	// Creates a buffer of size bytes on target and says whether the driver really gave it that storage
+	bool CreateBuffer(GLenum target, GLuint& id, GLsizeiptr size)
+	{
+		glGenBuffers(1, &id);
+		glBindBuffer(target, id);
+		glBufferData(target, size, nullptr, GL_STATIC_DRAW);
+
+		GLint created = 0;
+		glGetBufferParameteriv(target, GL_BUFFER_SIZE, &created);
+
+		return created == size;
+	}
+}
+
+void ArenaAllocator::Reset(GLuint capacity)
+{
+	this->capacity = capacity;
+	used = 0;
+
+	freeBlocks.clear();
+	if (capacity > 0)
+		freeBlocks.push_back({ 0, capacity });
+}
+
+bool ArenaAllocator::Allocate(GLuint size, GLuint& offset)
+{
+	for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it)
+	{
+		if (it->size < size)
+			continue;
+
+		offset = it->offset;
+		it->offset += size;
+		it->size -= size;
+
+		if (it->size == 0)
+			freeBlocks.erase(it);
+
+		used += size;
+		return true;
+	}
+
+	return false;
+}
+
+void ArenaAllocator::Free(GLuint offset, GLuint size)
+{
+	if (size == 0)
+		return;
+
+	InsertFreeBlock(offset, size);
+	used -= size;
+}
+
+void ArenaAllocator::Grow(GLuint newCapacity)
+{
+	if (newCapacity <= capacity)
+		return;
+
+	InsertFreeBlock(capacity, newCapacity - capacity);
+	capacity = newCapacity;
+}
+
+void ArenaAllocator::InsertFreeBlock(GLuint offset, GLuint size)
+{
+	auto it = std::lower_bound(freeBlocks.begin(), freeBlocks.end(), offset,
+		[](const Block& block, GLuint value) { return block.offset < value; });
+
+	it = freeBlocks.insert(it, { offset, size });
+
+	// Merge with the following block
+	auto next = it + 1;
+	if (next != freeBlocks.end() && it->offset + it->size == next->offset)
+	{
+		it->size += next->size;
+		it = freeBlocks.erase(next) - 1;
+	}
+
+	// Merge with the preceding block
+	if (it != freeBlocks.begin())
+	{
+		auto previous = it - 1;
+		if (previous->offset + previous->size == it->offset)
+		{
+			previous->size += it->size;
+			freeBlocks.erase(it);
+		}
+	}
+}
+
+GeometryArena::GeometryArena() : verticesId(0), normalsId(0), texCoordsId(0), indicesId(0)
+{
+}
+
+GeometryArena::~GeometryArena()
+{
+}
+
+bool GeometryArena::Init(GLuint vertexCapacity, GLuint indexCapacity)
+{
+	// Errors left queued by earlier setup are not the arena's, drop them so only its own are seen
+	while (glGetError() != GL_NO_ERROR) {}
+
+	bool created = CreateBuffer(GL_ARRAY_BUFFER, verticesId, sizeof(float) * 3 * vertexCapacity);
+	created = CreateBuffer(GL_ARRAY_BUFFER, normalsId, sizeof(float) * 3 * vertexCapacity) && created;
+	created = CreateBuffer(GL_ARRAY_BUFFER, texCoordsId, sizeof(float) * 2 * vertexCapacity) && created;
+	created = CreateBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesId, sizeof(uint32_t) * indexCapacity) && created;
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	// Out of memory is the only error that means the buffers are unusable
+	for (GLenum error = glGetError(); error != GL_NO_ERROR; error = glGetError())
+		created = created && error != GL_OUT_OF_MEMORY;
+
+	if (!created)
+		return false;
+
+	vertexAllocator.Reset(vertexCapacity);
+	indexAllocator.Reset(indexCapacity);
+	allocations = 0;
+
+	LOG(LogType::LOG_INFO, "Geometry arena created: %u vertices, %u indices", vertexCapacity, indexCapacity);
+
+	return true;
+}
+
+void GeometryArena::CleanUp()
+{
+	glDeleteBuffers(1, &verticesId);
+	glDeleteBuffers(1, &normalsId);
+	glDeleteBuffers(1, &texCoordsId);
+	glDeleteBuffers(1, &indicesId);
+
+	verticesId = 0;
+	normalsId = 0;
+	texCoordsId = 0;
+	indicesId = 0;
+}
+
+bool GeometryArena::Allocate(GLuint vertexCount, GLuint indexCount, GeometryAllocation& allocation)
+{
+	if (!IsInitialized() || vertexCount == 0 || indexCount == 0)
+		return false;
+
+	GLuint baseVertex = 0;
+	while (!vertexAllocator.Allocate(vertexCount, baseVertex))
+		GrowVertices(vertexAllocator.capacity * 2 + vertexCount);
+
+	GLuint firstIndex = 0;
+	while (!indexAllocator.Allocate(indexCount, firstIndex))
+		GrowIndices(indexAllocator.capacity * 2 + indexCount);
+
+	allocation.baseVertex = baseVertex;
+	allocation.vertexCount = vertexCount;
+	allocation.firstIndex = firstIndex;
+	allocation.indexCount = indexCount;
+
+	++allocations;
+	return true;
+}
+
+void GeometryArena::Free(GeometryAllocation& allocation)
+{
+	if (!allocation.IsValid())
+		return;
+
+	vertexAllocator.Free(allocation.baseVertex, allocation.vertexCount);
+	indexAllocator.Free(allocation.firstIndex, allocation.indexCount);
+	--allocations;
+
+	allocation = GeometryAllocation();
+}
+
+void GeometryArena::Upload(const GeometryAllocation& allocation, const float* vertices, const float* normals, GLuint normalsCount,
+	const float* texCoords, GLuint texCoordsCount, const uint32_t* indices)
+{
+	normalsCount = std::min(normalsCount, allocation.vertexCount);
+	texCoordsCount = std::min(texCoordsCount, allocation.vertexCount);
+
+	// Uploads go through the copy target so the bindings the draw code relies on are untouched
+	glBindBuffer(GL_COPY_WRITE_BUFFER, verticesId);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(float) * 3 * allocation.baseVertex, sizeof(float) * 3 * allocation.vertexCount, vertices);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, normalsId);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(float) * 3 * allocation.baseVertex, sizeof(float) * 3 * normalsCount, normals);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, texCoordsId);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(float) * 2 * allocation.baseVertex, sizeof(float) * 2 * texCoordsCount, texCoords);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, indicesId);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, sizeof(uint32_t) * allocation.firstIndex, sizeof(uint32_t) * allocation.indexCount, indices);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void GeometryArena::BindFixedFunction(GLStateCache& state) const
+{
+	for (GLuint attribute = 0; attribute < GL_STATE_ATTRIBUTES; ++attribute)
+		state.SetVertexAttribArray(attribute, false);
+
+	state.SetClientState(GL_VERTEX_ARRAY, true);
+	state.SetClientState(GL_NORMAL_ARRAY, true);
+	state.SetClientState(GL_TEXTURE_COORD_ARRAY, true);
+
+	if (state.SetVertexLayout(this, version * 2))
+	{
+		state.BindBuffer(GL_ARRAY_BUFFER, verticesId);
+		glVertexPointer(3, GL_FLOAT, 0, NULL);
+
+		state.BindBuffer(GL_ARRAY_BUFFER, normalsId);
+		glNormalPointer(GL_FLOAT, 0, NULL);
+
+		state.BindBuffer(GL_ARRAY_BUFFER, texCoordsId);
+		glTexCoordPointer(2, GL_FLOAT, 0, NULL);
+	}
+
+	state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesId);
+}
+
+void GeometryArena::BindAttributes(GLStateCache& state) const
+{
+	state.SetClientState(GL_VERTEX_ARRAY, false);
+	state.SetClientState(GL_NORMAL_ARRAY, false);
+	state.SetClientState(GL_TEXTURE_COORD_ARRAY, false);
+
+	// Generic attributes 0-2 match the layout of the instanced shader
+	state.SetVertexAttribArray(0, true);
+	state.SetVertexAttribArray(1, true);
+	state.SetVertexAttribArray(2, true);
+
+	if (state.SetVertexLayout(this, version * 2 + 1))
+	{
+		state.BindBuffer(GL_ARRAY_BUFFER, verticesId);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+
+		state.BindBuffer(GL_ARRAY_BUFFER, normalsId);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 0, NULL);
+
+		state.BindBuffer(GL_ARRAY_BUFFER, texCoordsId);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 0, NULL);
+	}
+
+	state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesId);
+}
+
+void GeometryArena::GrowVertices(GLuint newCapacity)
+{
+	LOG(LogType::LOG_INFO, "Geometry arena growing to %u vertices", newCapacity);
+
+	GrowBuffer(verticesId, sizeof(float) * 3 * vertexAllocator.capacity, sizeof(float) * 3 * newCapacity);
+	GrowBuffer(normalsId, sizeof(float) * 3 * vertexAllocator.capacity, sizeof(float) * 3 * newCapacity);
+	GrowBuffer(texCoordsId, sizeof(float) * 2 * vertexAllocator.capacity, sizeof(float) * 2 * newCapacity);
+
+	vertexAllocator.Grow(newCapacity);
+}
+
+void GeometryArena::GrowIndices(GLuint newCapacity)
+{
+	LOG(LogType::LOG_INFO, "Geometry arena growing to %u indices", newCapacity);
+
+	GrowBuffer(indicesId, sizeof(uint32_t) * indexAllocator.capacity, sizeof(uint32_t) * newCapacity);
+
+	indexAllocator.Grow(newCapacity);
+}
+
+void GeometryArena::GrowBuffer(GLuint& buffer, size_t oldSize, size_t newSize)
+{
+	GLuint newBuffer = 0;
+	glGenBuffers(1, &newBuffer);
+
+	glBindBuffer(GL_COPY_WRITE_BUFFER, newBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, newSize, nullptr, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, oldSize);
+
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	glDeleteBuffers(1, &buffer);
+	buffer = newBuffer;
+	++version;
+}
\ No newline at end of file
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "GLStateCache.h"
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <vector>
+
+// Offsets into the shared buffers, counted in vertices and indices
+struct GeometryAllocation
+{
+	GLuint baseVertex = 0;
+	GLuint vertexCount = 0;
+	GLuint firstIndex = 0;
+	GLuint indexCount = 0;
+
+	bool IsValid() const { return vertexCount > 0 && indexCount > 0; }
+};
+
+// First-fit free list over a linear range, neighbouring free blocks are merged on release
+class ArenaAllocator
+{
+public:
+	void Reset(GLuint capacity);
+	bool Allocate(GLuint size, GLuint& offset);
+	void Free(GLuint offset, GLuint size);
+	void Grow(GLuint newCapacity);
+
+public:
+	GLuint capacity = 0;
+	GLuint used = 0;
+
+private:
+	struct Block
+	{
+		GLuint offset;
+		GLuint size;
+	};
+
+	void InsertFreeBlock(GLuint offset, GLuint size);
+
+	std::vector<Block> freeBlocks;
+};
+
+// One set of vertex, normal, texcoord and index buffers shared by every Mesh
+class GeometryArena
+{
+public:
+	GeometryArena();
+	~GeometryArena();
+
+	bool Init(GLuint vertexCapacity, GLuint indexCapacity);
+	void CleanUp();
+
+	bool Allocate(GLuint vertexCount, GLuint indexCount, GeometryAllocation& allocation);
+	void Free(GeometryAllocation& allocation);
+	void Upload(const GeometryAllocation& allocation, const float* vertices, const float* normals, GLuint normalsCount,
+		const float* texCoords, GLuint texCoordsCount, const uint32_t* indices);
+
+	void BindFixedFunction(GLStateCache& state) const;
+	void BindAttributes(GLStateCache& state) const;
+
+	bool IsInitialized() const { return verticesId != 0; }
+
+public:
+	GLuint verticesId;
+	GLuint normalsId;
+	GLuint texCoordsId;
+	GLuint indicesId;
+
+	ArenaAllocator vertexAllocator;
+	ArenaAllocator indexAllocator;
+	int allocations = 0;
+
+private:
+	// Bumped whenever the buffers are replaced so cached attribute pointers get set again
+	unsigned int version = 1;
+
+	void GrowVertices(GLuint newCapacity);
+	void GrowIndices(GLuint newCapacity);
+	void GrowBuffer(GLuint& buffer, size_t oldSize, size_t newSize);
+};
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "GpuProfiler.h"
+#include "Logger.h"
+
+GpuProfiler::GpuProfiler()
+{
+}
+
+bool GpuProfiler::Init()
+{
+	available = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+	if (!available)
+	{
+		LOG(LogType::LOG_WARNING, "Timer queries not supported, GPU stage timings disabled");
+		return false;
+	}
+
+	for (int set = 0; set < GPU_PROFILER_FRAMES; ++set)
+		glGenQueries((GLsizei)GpuStage::COUNT, queries[set]);
+
+	return true;
+}
+
+void GpuProfiler::CleanUp()
+{
+	if (!available)
+		return;
+
+	for (int set = 0; set < GPU_PROFILER_FRAMES; ++set)
+	{
+		glDeleteQueries((GLsizei)GpuStage::COUNT, queries[set]);
+
+		for (int stage = 0; stage < (int)GpuStage::COUNT; ++stage)
+			issued[set][stage] = false;
+	}
+
+	available = false;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	frameActive = available && enabled;
+	if (!frameActive)
+		return;
+
+	currentSet = (currentSet + 1) % GPU_PROFILER_FRAMES;
+
+	// This set was issued GPU_PROFILER_FRAMES frames ago, collect it before reusing its queries
+	CollectResults(currentSet);
+}
+
+void GpuProfiler::EndFrame()
+{
+	frameActive = false;
+}
+
+void GpuProfiler::Publish()
+{
+	for (int stage = 0; stage < (int)GpuStage::COUNT; ++stage)
+		timings[stage] = collected[stage];
+
+	frameMs = collectedFrameMs;
+	droppedFrames = collectedDroppedFrames;
+}
+
+void GpuProfiler::Begin(GpuStage stage)
+{
+	if (!frameActive)
+		return;
+
+	glBeginQuery(GL_TIME_ELAPSED, queries[currentSet][(int)stage]);
+}
+
+void GpuProfiler::End(GpuStage stage)
+{
+	if (!frameActive)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+	issued[currentSet][(int)stage] = true;
+}
+
+const char* GpuProfiler::GetStageName(GpuStage stage)
+{
+	switch (stage)
+	{
+	case GpuStage::SCENE: return "Scene";
+	case GpuStage::DEBUG_NORMALS: return "Debug Normals";
+	case GpuStage::GRID: return "Grid";
+	case GpuStage::IMGUI: return "ImGui";
+	default: return "Unknown";
+	}
+}
+
+void GpuProfiler::CollectResults(int set)
+{
+	// If the last stage is not done yet none of the earlier ones are read either, the frame is dropped
+	for (int stage = (int)GpuStage::COUNT - 1; stage >= 0; --stage)
+	{
+		if (!issued[set][stage])
+			continue;
+
+		GLint ready = GL_FALSE;
+		glGetQueryObjectiv(queries[set][stage], GL_QUERY_RESULT_AVAILABLE, &ready);
+		if (ready != GL_TRUE)
+		{
+			for (int i = 0; i < (int)GpuStage::COUNT; ++i)
+				issued[set][i] = false;
+
+			++collectedDroppedFrames;
+			return;
+		}
+
+		break;
+	}
+
+	float total = 0.0f;
+	bool any = false;
+
+	for (int stage = 0; stage < (int)GpuStage::COUNT; ++stage)
+	{
+		if (!issued[set][stage])
+			continue;
+
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(queries[set][stage], GL_QUERY_RESULT, &elapsed);
+		issued[set][stage] = false;
+
+		float ms = (float)(elapsed / 1000000.0);
+		AddSample(collected[stage], ms);
+
+		total += ms;
+		any = true;
+	}
+
+	if (any)
+		collectedFrameMs = total;
+}
+
+void GpuProfiler::AddSample(GpuStageTimings& stage, float ms)
+{
+	stage.lastMs = ms;
+	stage.history[stage.historyOffset] = ms;
+	stage.historyOffset = (stage.historyOffset + 1) % GPU_PROFILER_HISTORY;
+
+	if (stage.samples < GPU_PROFILER_HISTORY)
+		stage.samples++;
+
+	// Min/avg/max cover the same window as the graph
+	stage.minMs = ms;
+	stage.maxMs = ms;
+	float sum = 0.0f;
+
+	for (int i = 0; i < stage.samples; ++i)
+	{
+		float sample = stage.history[i];
+		stage.minMs = sample < stage.minMs ? sample : stage.minMs;
+		stage.maxMs = sample > stage.maxMs ? sample : stage.maxMs;
+		sum += sample;
+	}
+
+	stage.avgMs = sum / stage.samples;
+}
\ No newline at end of file
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+
+#define GPU_PROFILER_FRAMES 2
+#define GPU_PROFILER_HISTORY 100
+
+enum class GpuStage : uint8_t
+{
+	SCENE,
+	DEBUG_NORMALS,
+	GRID,
+	IMGUI,
+	COUNT
+};
+
+struct GpuStageTimings
+{
+	float history[GPU_PROFILER_HISTORY] = {};
+	int historyOffset = 0;
+	int samples = 0;
+
+	float lastMs = 0.0f;
+	float minMs = 0.0f;
+	float avgMs = 0.0f;
+	float maxMs = 0.0f;
+};
+
+// Times each render stage with GL_TIME_ELAPSED queries. Results are read a frame later from
+// the other query set and only once available, so the CPU never waits on the GPU
+class GpuProfiler
+{
+public:
+	GpuProfiler();
+
+	bool Init();
+	void CleanUp();
+
+	void BeginFrame();
+	void EndFrame();
+
+	// Makes the collected results visible, called while nothing is rendering
+	void Publish();
+
+	// Stages cannot nest, GL allows a single GL_TIME_ELAPSED query at a time
+	void Begin(GpuStage stage);
+	void End(GpuStage stage);
+
+	bool IsAvailable() const { return available; }
+	const GpuStageTimings& GetTimings(GpuStage stage) const { return timings[(int)stage]; }
+	static const char* GetStageName(GpuStage stage);
+
+public:
+	bool enabled = true;
+
+	// Sum of the stages of the last resolved frame, as of the last Publish
+	float frameMs = 0.0f;
+	int droppedFrames = 0;
+
+private:
+	void CollectResults(int set);
+	void AddSample(GpuStageTimings& stage, float ms);
+
+private:
+	bool available = false;
+	bool frameActive = false;
+	int currentSet = 0;
+
+	GLuint queries[GPU_PROFILER_FRAMES][(int)GpuStage::COUNT] = {};
+	bool issued[GPU_PROFILER_FRAMES][(int)GpuStage::COUNT] = {};
+
+	GpuStageTimings collected[(int)GpuStage::COUNT];
+	float collectedFrameMs = 0.0f;
+	int collectedDroppedFrames = 0;
+
+	GpuStageTimings timings[(int)GpuStage::COUNT];
+};
\ No newline at end of file
@@ -1,57 +1,116 @@
 #include "Grid.h"
+#include "GLStateCache.h"
 #include "GL/glew.h"
 
+#include <vector>
+
 Grid::Grid()
 {
 }
 
-void Grid::Render() const
+Grid::~Grid()
+{
+}
+
+void Grid::Render(GLStateCache& state)
 {
+	if (NeedsRebuild())
+		Rebuild();
+
+	if (vertexCount == 0)
+		return;
+
 	glLineWidth(lineWidth);
 
-	glEnable(GL_BLEND);
+	state.UseProgram(0);
+	state.SetEnabled(GL_BLEND, true);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+	state.SetEnabled(GL_TEXTURE_2D, false);
 	glColor4f(lineColor[0], lineColor[1], lineColor[2], lineColor[3]);
 
-	glBegin(GL_LINES);
+	for (GLuint attribute = 0; attribute < GL_STATE_ATTRIBUTES; ++attribute)
+		state.SetVertexAttribArray(attribute, false);
 
-	float start = -gridSize - fmod(-gridSize, cellSize);
-	float end = gridSize - fmod(gridSize, cellSize);
+	state.SetClientState(GL_VERTEX_ARRAY, true);
+	state.SetClientState(GL_NORMAL_ARRAY, false);
+	state.SetClientState(GL_TEXTURE_COORD_ARRAY, false);
 
-	if (normal.x == 1.0f) {
-		// Grid YZ
-		for (float i = start; i <= end; i += cellSize)
-		{
-			glVertex3f(0.0f, i, -gridSize);
-			glVertex3f(0.0f, i, gridSize);
-			glVertex3f(0.0f, -gridSize, i);
-			glVertex3f(0.0f, gridSize, i);
-		}
+	if (state.SetVertexLayout(this, 0))
+	{
+		state.BindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
+		glVertexPointer(3, GL_FLOAT, 0, NULL);
 	}
-	else if (normal.y == 1.0f) {
-		// Grid XZ
-		for (float i = start; i <= end; i += cellSize)
-		{
-			glVertex3f(i, 0.0f, -gridSize);
-			glVertex3f(i, 0.0f, gridSize);
-			glVertex3f(-gridSize, 0.0f, i);
-			glVertex3f(gridSize, 0.0f, i);
-		}
+
+	glDrawArrays(GL_LINES, 0, vertexCount);
+
+	state.SetEnabled(GL_BLEND, false);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void Grid::CleanUp()
+{
+	if (vertexBuffer != 0)
+	{
+		glDeleteBuffers(1, &vertexBuffer);
+		vertexBuffer = 0;
 	}
-	else if (normal.z == 1.0f) {
-		// Grid XY
+
+	vertexCount = 0;
+}
+
+bool Grid::NeedsRebuild() const
+{
+	return vertexBuffer == 0 || builtNormal != normal || builtCellSize != cellSize || builtGridSize != gridSize;
+}
+
+void Grid::Rebuild()
+{
+	builtNormal = normal;
+	builtCellSize = cellSize;
+	builtGridSize = gridSize;
+
+	std::vector<glm::vec3> vertices;
+
+	if (cellSize > 0.0f)
+	{
+		float start = -gridSize - fmod(-gridSize, cellSize);
+		float end = gridSize - fmod(gridSize, cellSize);
+
+		vertices.reserve((size_t)((end - start) / cellSize + 1) * 4);
+
 		for (float i = start; i <= end; i += cellSize)
 		{
-			glVertex3f(i, -gridSize, 0.0f);
-			glVertex3f(i, gridSize, 0.0f);
-			glVertex3f(-gridSize, i, 0.0f);
-			glVertex3f(gridSize, i, 0.0f);
+			if (normal.x == 1.0f) {
+				// Grid YZ
+				vertices.emplace_back(0.0f, i, -gridSize);
+				vertices.emplace_back(0.0f, i, gridSize);
+				vertices.emplace_back(0.0f, -gridSize, i);
+				vertices.emplace_back(0.0f, gridSize, i);
+			}
+			else if (normal.y == 1.0f) {
+				// Grid XZ
+				vertices.emplace_back(i, 0.0f, -gridSize);
+				vertices.emplace_back(i, 0.0f, gridSize);
+				vertices.emplace_back(-gridSize, 0.0f, i);
+				vertices.emplace_back(gridSize, 0.0f, i);
+			}
+			else if (normal.z == 1.0f) {
+				// Grid XY
+				vertices.emplace_back(i, -gridSize, 0.0f);
+				vertices.emplace_back(i, gridSize, 0.0f);
+				vertices.emplace_back(-gridSize, i, 0.0f);
+				vertices.emplace_back(gridSize, i, 0.0f);
+			}
 		}
 	}
 
-	glEnd();
+	if (vertexBuffer == 0)
+		glGenBuffers(1, &vertexBuffer);
 
-	glDisable(GL_BLEND);
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vertexBuffer);
+	glBufferData(GL_COPY_WRITE_BUFFER, sizeof(glm::vec3) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	vertexCount = (int)vertices.size();
 }
\ No newline at end of file
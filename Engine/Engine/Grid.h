@@ -2,11 +2,21 @@
 
 #include "glm/glm.hpp"
 
+class GLStateCache;
+
 class Grid
 {
 public:
 	Grid();
-	void Render() const;
+	~Grid();
+
+	void Render(GLStateCache& state);
+	void CleanUp();
+
+private:
+	bool NeedsRebuild() const;
+	void Rebuild();
+
 public:
 	glm::vec3 normal = glm::vec3(0, 1, 0);
 
@@ -14,4 +24,13 @@ public:
 	float cellSize = 1.0f;
 	float gridSize = 200.0f;
 	float lineWidth = 1.0f;
+
+private:
+	// Lines live in a VBO that is only regenerated when the layout parameters change
+	unsigned int vertexBuffer = 0;
+	int vertexCount = 0;
+
+	glm::vec3 builtNormal = glm::vec3(0.0f);
+	float builtCellSize = 0.0f;
+	float builtGridSize = 0.0f;
 };
\ No newline at end of file
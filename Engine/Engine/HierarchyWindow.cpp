@@ -14,7 +14,7 @@ HierarchyWindow::~HierarchyWindow()
 
 void HierarchyWindow::DeleteSelectedGameObject()
 {
-    GameObject* objectToDelete = app->editor->selectedGameObject;
+    GameObject* objectToDelete = app->editor->GetSelectedGameObject();
 
     // Validaciones de seguridad
     if (!objectToDelete || objectToDelete == app->scene->root || !objectToDelete->parent)
@@ -23,60 +23,9 @@ void HierarchyWindow::DeleteSelectedGameObject()
         return;
     }
 
-    // Guardamos una referencia al padre antes de borrar
-    GameObject* parent = objectToDelete->parent;
-
-    // Limpiamos la seleccin antes de borrar
-    app->editor->selectedGameObject = nullptr;
-
-    // Encuentra y elimina el objeto de la lista de hijos del padre
-    if (parent)
-    {
-        auto& parentChildren = parent->children;
-        auto it = std::find(parentChildren.begin(), parentChildren.end(), objectToDelete);
-        if (it != parentChildren.end())
-        {
-            parentChildren.erase(it);
-        }
-    }
-
-    // Elimina el objeto y sus hijos recursivamente
-    DeleteGameObjectRecursive(objectToDelete);
-}
-
-void HierarchyWindow::DeleteGameObjectRecursive(GameObject* gameObject)
-{
-    if (!gameObject)
-    {
-        return;
-    }
-
-    // Crea una copia de los hijos ya que vamos a modificar el vector
-    std::vector<GameObject*> childrenCopy = gameObject->children;
-
-    // Elimina recursivamente todos los hijos
-    for (auto* child : childrenCopy)
-    {
-        if (child)
-        {
-            DeleteGameObjectRecursive(child);
-        }
-    }
-
-    // Limpia los componentes
-    for (auto* component : gameObject->components)
-    {
-        if (component)
-        {
-            std::cout << "Deleting component: " << component << std::endl;
-            delete component;
-        }
-    }
-    gameObject->components.clear();
-
-    // Finalmente elimina el GameObject
-    std::cout << "Deleting GameObject: " << gameObject << std::endl;
-    delete gameObject;
+    // Also unlinks it from its parent, the selection handle stops resolving on its own.
+    // Static batches and occluders are invalidated there too
+    app->scene->DestroyGameObject(objectToDelete);
 }
 
 void HierarchyWindow::DrawWindow()
@@ -86,8 +35,9 @@ void HierarchyWindow::DrawWindow()
     UpdateMouseState();
 
     // Aade la deteccin de la tecla Supr aqu
-    if (app->editor->selectedGameObject != nullptr &&
-        app->editor->selectedGameObject != app->scene->root &&
+    GameObject* selectedGameObject = app->editor->GetSelectedGameObject();
+    if (selectedGameObject != nullptr &&
+        selectedGameObject != app->scene->root &&
         ImGui::IsKeyPressed(ImGuiKey_Delete) &&
         ImGui::IsWindowFocused())
     {
@@ -103,8 +53,7 @@ void HierarchyWindow::DrawWindow()
     {
         if (ImGui::MenuItem("Create Empty"))
         {
-            app->scene->CreateGameObject("GameObject", app->scene->root);
-            app->editor->selectedGameObject = app->scene->root->children.back();
+            app->editor->SetSelectedGameObject(app->scene->CreateGameObject("GameObject", app->scene->root));
         }
         if (ImGui::BeginMenu("3D Object"))
         {
@@ -123,7 +72,7 @@ void HierarchyWindow::DrawWindow()
                         resource = app->importer->ImportFileToLibrary(fullPath, ResourceType::MODEL);
 
                     app->importer->modelImporter->LoadModel(resource, app->scene->root);
-                    app->editor->selectedGameObject = app->scene->root->children.back();
+                    app->editor->SetSelectedGameObject(app->scene->root->children.back());
                 }
             }
 
@@ -140,7 +89,8 @@ void HierarchyWindow::DrawWindow()
 
     ImGui::BeginGroup();
 
-    HierarchyTree(app->scene->root, true, searchInput);
+    RebuildRows();
+    DrawRows();
 
     ImVec2 availableSize = ImGui::GetContentRegionAvail();
 
@@ -161,96 +111,234 @@ void HierarchyWindow::DrawWindow()
     ImGui::End();
 }
 
-void HierarchyWindow::HierarchyTree(GameObject* node, bool isRoot, const char* searchText)
+void HierarchyWindow::RebuildRows()
 {
-    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow;
+    const bool searching = searchInput[0] != '\0';
 
-    if (isRoot)
+    if (searching)
     {
-        flags |= ImGuiTreeNodeFlags_DefaultOpen;
+        UpdateSearchResults();
+        if (searchUpdated)
+        {
+            searchCollapsed.clear();
+            rowsDirty = true;
+        }
     }
 
-    if (node->children.empty())
+    if (searching != rowsForSearch || rowsHierarchyVersion != app->scene->GetHierarchyVersion())
     {
-        flags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+        rowsDirty = true;
     }
 
-    bool isSelected = (app->editor->selectedGameObject == node);
-
-    if (isSelected)
+    if (!rowsDirty)
     {
-        flags |= ImGuiTreeNodeFlags_Selected;
+        return;
     }
 
-    if (!node->isActive)
+    rows.clear();
+    rowsForSearch = searching;
+    rowsHierarchyVersion = app->scene->GetHierarchyVersion();
+    rowsDirty = false;
+
+    if (searching)
     {
-        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
+        AddSearchRows(app->scene->root, 0);
     }
-
-    if (FilterNode(node, searchText))
+    else
     {
-        bool isOpen = ImGui::TreeNodeEx(node, flags, node->name.c_str());
+        AddRows(app->scene->root, 0);
+    }
+}
 
-        if (ImGui::IsItemClicked())
+void HierarchyWindow::AddRows(GameObject* node, int depth)
+{
+    HierarchyRow row;
+    row.node = node;
+    row.depth = depth;
+    row.hasChildren = !node->children.empty();
+    rows.push_back(row);
+
+    if (node->isExpanded)
+    {
+        for (GameObject* child : node->children)
         {
-            if (app->editor->selectedGameObject && app->editor->selectedGameObject->isEditing)
-            {
-                app->editor->selectedGameObject->isEditing = false;
-            }
-            app->editor->selectedGameObject = node;
+            AddRows(child, depth + 1);
         }
+    }
+}
 
-        if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0) && !ImGui::IsItemToggledOpen())
+void HierarchyWindow::AddSearchRows(GameObject* node, int depth)
+{
+    auto children = searchChildren.find(node);
+
+    HierarchyRow row;
+    row.node = node;
+    row.depth = depth;
+    row.hasChildren = children != searchChildren.end();
+    row.dimmed = searchMatched.count(node) == 0;
+    rows.push_back(row);
+
+    if (row.hasChildren && searchCollapsed.count(node) == 0)
+    {
+        for (GameObject* child : children->second)
         {
-            node->isEditing = true;
+            AddSearchRows(child, depth + 1);
         }
+    }
+}
 
-        // Rename node
-        if (node->isEditing)
-        {
-            strcpy_s(inputName, app->editor->selectedGameObject->name.c_str());
-            ImGui::SetNextItemWidth(ImGui::CalcTextSize(node->name.c_str()).x + 100);
-            if (ImGui::InputText("##edit", inputName, sizeof(inputName), inputTextFlags)
-                || (!ImGui::IsItemActive() && !ImGui::IsAnyItemActive()))
-            {
-                if (inputName[0] != '\0') node->name = inputName;
-                node->isEditing = false;
-            }
+void HierarchyWindow::DrawRows()
+{
+    ImGuiListClipper clipper;
+    clipper.Begin((int)rows.size());
 
-            ImGui::SetKeyboardFocusHere(-1);
+    while (clipper.Step())
+    {
+        for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; i++)
+        {
+            DrawRow(rows[i]);
         }
+    }
+
+    clipper.End();
+}
 
-        // Create child nodes
-        if (isOpen && !node->children.empty())
+void HierarchyWindow::DrawRow(const HierarchyRow& row)
+{
+    GameObject* node = row.node;
+
+    // Rows are flat, nothing is pushed on the tree stack and the depth is only indentation
+    ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_OpenOnArrow | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+    if (!row.hasChildren)
+    {
+        flags |= ImGuiTreeNodeFlags_Leaf;
+    }
+
+    bool isExpanded = rowsForSearch ? searchCollapsed.count(node) == 0 : node->isExpanded;
+
+    float indent = row.depth * ImGui::GetStyle().IndentSpacing;
+    if (indent > 0.0f)
+    {
+        ImGui::Indent(indent);
+    }
+
+    ImGui::SetNextItemOpen(isExpanded);
+    bool isOpen = DrawNode(node, flags, row.dimmed);
+
+    if (indent > 0.0f)
+    {
+        ImGui::Unindent(indent);
+    }
+
+    // Takes effect with next frame's rows
+    if (row.hasChildren && isOpen != isExpanded)
+    {
+        if (rowsForSearch)
         {
-            for (unsigned int i = 0; i < node->children.size(); i++)
-            {
-                HierarchyTree(node->children[i], false, searchText);
-            }
-            ImGui::TreePop();
+            if (isOpen)
+                searchCollapsed.erase(node);
+            else
+                searchCollapsed.insert(node);
+        }
+        else
+        {
+            node->isExpanded = isOpen;
         }
 
-        if (!node->isActive)
+        rowsDirty = true;
+    }
+}
+
+bool HierarchyWindow::DrawNode(GameObject* node, ImGuiTreeNodeFlags flags, bool dimmed)
+{
+    GameObject* selectedGameObject = app->editor->GetSelectedGameObject();
+    bool isSelected = (selectedGameObject == node);
+
+    if (isSelected)
+    {
+        flags |= ImGuiTreeNodeFlags_Selected;
+    }
+
+    // Inactive here or in any ancestor
+    bool isGrayed = dimmed || !app->scene->entities.IsEnabled(node->entity);
+    if (isGrayed)
+    {
+        ImGui::PushStyleColor(ImGuiCol_Text, ImVec4(0.5f, 0.5f, 0.5f, 1.0f));
+    }
+
+    bool isOpen = ImGui::TreeNodeEx(node, flags, node->name.c_str());
+
+    if (isGrayed)
+    {
+        ImGui::PopStyleColor();
+    }
+
+    if (ImGui::IsItemClicked())
+    {
+        if (selectedGameObject && selectedGameObject->isEditing)
         {
-            ImGui::PopStyleColor();
+            selectedGameObject->isEditing = false;
         }
+        app->editor->SetSelectedGameObject(node);
     }
-    else
+
+    if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(0) && !ImGui::IsItemToggledOpen())
     {
-        for (unsigned int i = 0; i < node->children.size(); i++)
+        node->isEditing = true;
+    }
+
+    // Rename node
+    if (node->isEditing)
+    {
+        strcpy_s(inputName, node->name.c_str());
+        ImGui::SetNextItemWidth(ImGui::CalcTextSize(node->name.c_str()).x + 100);
+        if (ImGui::InputText("##edit", inputName, sizeof(inputName), inputTextFlags)
+            || (!ImGui::IsItemActive() && !ImGui::IsAnyItemActive()))
         {
-            HierarchyTree(node->children[i], false, searchText);
+            if (inputName[0] != '\0') node->SetName(inputName);
+            node->isEditing = false;
         }
+
+        ImGui::SetKeyboardFocusHere(-1);
     }
+
+    return isOpen;
 }
 
-bool HierarchyWindow::FilterNode(GameObject* node, const char* searchText)
+void HierarchyWindow::UpdateSearchResults()
 {
-    std::string nodeNameLower = node->name;
-    std::transform(nodeNameLower.begin(), nodeNameLower.end(), nodeNameLower.begin(), ::tolower);
+    NameIndex& names = app->scene->names;
 
-    std::string searchTextLower = searchText;
-    std::transform(searchTextLower.begin(), searchTextLower.end(), searchTextLower.begin(), ::tolower);
+    searchUpdated = searchQuery != searchInput || searchVersion != names.GetVersion();
+    if (!searchUpdated)
+    {
+        return;
+    }
+
+    searchQuery = searchInput;
+    searchVersion = names.GetVersion();
+
+    names.Find(searchInput, searchMatches);
+
+    searchMatched.clear();
+    searchVisible.clear();
+    searchChildren.clear();
+
+    // Each match links itself to its parent, then the parent to its own, until reaching a linked one
+    for (GameObjectHandle handle : searchMatches)
+    {
+        GameObject* node = app->scene->GetGameObject(handle);
+        if (node == nullptr)
+        {
+            continue;
+        }
+
+        searchMatched.insert(node);
 
-    return nodeNameLower.find(searchTextLower) != std::string::npos;
+        while (node->parent != nullptr && searchVisible.insert(node).second)
+        {
+            searchChildren[node->parent].push_back(node);
+            node = node->parent;
+        }
+    }
 }
\ No newline at end of file
@@ -3,6 +3,20 @@
 #include "EditorWindow.h"
 #include "GameObject.h"
 
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// One visible line of the tree
+struct HierarchyRow
+{
+	GameObject* node = nullptr;
+	int depth = 0;
+	bool hasChildren = false;
+	// Shown only because a descendant matches the search
+	bool dimmed = false;
+};
+
 class HierarchyWindow : public EditorWindow
 {
 public:
@@ -11,15 +25,40 @@ public:
 
 	void DrawWindow() override;
 
-	void HierarchyTree(GameObject* node, bool isRoot = false, const char* searchText = "");
-	bool FilterNode(GameObject* node, const char* searchText);
-
 private:
+	// The expanded tree flattened into rows, or only the search matches and their ancestors. Rebuilt
+	// when objects are created or destroyed, something is expanded or collapsed, or the search changes
+	void RebuildRows();
+	void AddRows(GameObject* node, int depth);
+	void AddSearchRows(GameObject* node, int depth);
+	// Only the rows on screen are submitted
+	void DrawRows();
+	void DrawRow(const HierarchyRow& row);
+
+	// The row itself, true if it is open
+	bool DrawNode(GameObject* node, ImGuiTreeNodeFlags flags, bool dimmed);
+	void UpdateSearchResults();
 	void DeleteSelectedGameObject();
-	void DeleteGameObjectRecursive(GameObject* gameObject);
 	bool IsGameObjectValid(GameObject* gameObject) const;  // Nueva funcin de validacin
 
 	char searchInput[256] = "";
+
+	// Rebuilt from the scene's name index when the query or any name changes
+	std::string searchQuery;
+	uint32_t searchVersion = 0;
+	bool searchUpdated = false;
+	std::vector<GameObjectHandle> searchMatches;
+	std::unordered_set<GameObject*> searchMatched;
+	std::unordered_set<GameObject*> searchVisible;
+	std::unordered_map<GameObject*, std::vector<GameObject*>> searchChildren;
+	// Expansion is kept apart while searching, every path starts open
+	std::unordered_set<GameObject*> searchCollapsed;
+
+	std::vector<HierarchyRow> rows;
+	bool rowsDirty = true;
+	bool rowsForSearch = false;
+	uint32_t rowsHierarchyVersion = 0;
+
 	char inputName[256] = "GameObject";
 	ImGuiInputTextFlags inputTextFlags = ImGuiInputTextFlags_EnterReturnsTrue | ImGuiInputTextFlags_AutoSelectAll;
 };
\ No newline at end of file
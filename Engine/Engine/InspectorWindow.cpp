@@ -16,17 +16,24 @@ void InspectorWindow::DrawWindow()
 
 	UpdateMouseState();
 
-	if (app->editor->selectedGameObject != nullptr && app->editor->selectedGameObject->parent != nullptr)
+	GameObject* selectedGameObject = app->editor->GetSelectedGameObject();
+
+	if (selectedGameObject != nullptr && selectedGameObject->parent != nullptr)
 	{
-		ImGui::Checkbox("##Active", &app->editor->selectedGameObject->isActive);
+		bool isActive = selectedGameObject->isActive;
+		if (ImGui::Checkbox("##Active", &isActive))
+		{
+			selectedGameObject->SetActive(isActive);
+			app->renderer3D->staticBatcher.MarkDirty();
+		}
 		ImGui::SameLine();
 
-		strcpy_s(inputName, app->editor->selectedGameObject->name.c_str());
+		strcpy_s(inputName, selectedGameObject->name.c_str());
 
 		if (ImGui::InputText("##InspectorName", inputName, sizeof(inputName), inputTextFlags)
 			|| (isEditingInspector && !ImGui::IsItemActive() && !ImGui::IsAnyItemActive()))
 		{
-			if (inputName[0] != '\0') app->editor->selectedGameObject->name = inputName;
+			if (inputName[0] != '\0') selectedGameObject->SetName(inputName);
 			isEditingInspector = false;
 		}
 
@@ -36,9 +43,20 @@ void InspectorWindow::DrawWindow()
 			ImGui::SetKeyboardFocusHere(-1);
 		}
 
-		for (auto i = 0; i < app->editor->selectedGameObject->components.size(); i++)
+		ImGui::SameLine();
+		bool isStatic = selectedGameObject->isStatic;
+		if (ImGui::Checkbox("Static", &isStatic))
+		{
+			selectedGameObject->SetStatic(isStatic);
+			app->renderer3D->staticBatcher.MarkDirty();
+		}
+
+		static const ComponentType componentTypes[] = { ComponentType::TRANSFORM, ComponentType::MESH, ComponentType::MATERIAL };
+
+		for (ComponentType type : componentTypes)
 		{
-			app->editor->selectedGameObject->components[i]->OnEditor();
+			if (Component* component = selectedGameObject->GetComponent(type))
+				component->OnEditor();
 		}
 	}
 
@@ -1,6 +1,7 @@
 #include "Logger.h"
 
 #include <windows.h>
+#include <mutex>
 
 Logger logger;
 
@@ -10,6 +11,10 @@ void Logger::Log(const char file[], int line, LogType type, const char* format,
 	static char tmpString2[4096];
 	static va_list ap;
 
+	// Jobs log from worker threads too
+	static std::mutex logMutex;
+	std::lock_guard<std::mutex> lock(logMutex);
+
 	const char* filename = strrchr(file, '\\');
 	if (!filename) {
 		filename = strrchr(file, '/');
@@ -1,6 +1,9 @@
 #include "Mesh.h"
 #include "GL/glew.h"
 #include "Logger.h"
+#include "App.h"
+
+#include <vector>
 
 Mesh::Mesh() :
     vertices(nullptr),
@@ -11,10 +14,8 @@ Mesh::Mesh() :
     indicesCount(0),
     normalsCount(0),
     texCoordsCount(0),
-    verticesId(0),
-    indicesId(0),
-    normalsId(0),
-    texCoordsId(0),
+    aabbMin(0.0f),
+    aabbMax(0.0f),
     initialized(false)
 {
     diffuseColor = glm::vec4(1.0f);
@@ -103,33 +104,24 @@ bool Mesh::InitMesh()
         return false;
     }
 
+    // The arena may be drawn from on the render thread
+    GLContextLock lock(app->renderer3D->renderThread);
+
     if (initialized) {
-        CleanUp();
+        ReleaseGeometry();
+        ReleaseNormalLines();
     }
 
     try {
-        // Vertices
-        glGenBuffers(1, &verticesId);
-        glBindBuffer(GL_ARRAY_BUFFER, verticesId);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * verticesCount * 3, vertices, GL_STATIC_DRAW);
-
-        // Indices
-        glGenBuffers(1, &indicesId);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesId);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indicesCount, indices, GL_STATIC_DRAW);
-
-        // Normals
-        glGenBuffers(1, &normalsId);
-        glBindBuffer(GL_ARRAY_BUFFER, normalsId);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * normalsCount * 3, normals, GL_STATIC_DRAW);
-
-        // Texture Coords
-        glGenBuffers(1, &texCoordsId);
-        glBindBuffer(GL_ARRAY_BUFFER, texCoordsId);
-        glBufferData(GL_ARRAY_BUFFER, sizeof(float) * texCoordsCount * 2, texCoords, GL_STATIC_DRAW);
+        // Geometry lives in the renderer's shared buffers, the mesh only keeps its offsets
+        GeometryArena& arena = app->renderer3D->geometryArena;
+        if (!arena.Allocate(verticesCount, indicesCount, allocation)) {
+            LOG(LogType::LOG_ERROR, "Failed to initialize mesh: Could not allocate geometry");
+            return false;
+        }
 
-        glBindBuffer(GL_ARRAY_BUFFER, 0);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+        arena.Upload(allocation, vertices, normals, normalsCount, texCoords, texCoordsCount, indices);
+        ComputeBounds();
 
         initialized = true;
         LOG(LogType::LOG_INFO, "Mesh initialized successfully");
@@ -149,49 +141,44 @@ bool Mesh::DrawMesh(uint textureId, bool hasTexture, bool wireframe, bool cullfa
         return false;
     }
 
-    if (wireframe)
-        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-
-    if (cullface)
-        glEnable(GL_CULL_FACE);
-    else
-        glDisable(GL_CULL_FACE);
+    // State goes through the renderer's cache, consecutive draws only pay for what differs
+    GLStateCache& state = app->renderer3D->glState;
+    bool textured = hasTexture && textureId != 0;
 
-    glEnableClientState(GL_VERTEX_ARRAY);
-    glEnableClientState(GL_NORMAL_ARRAY);
-    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    state.UseProgram(0);
+    state.PolygonMode(wireframe ? GL_LINE : GL_FILL);
+    state.SetEnabled(GL_CULL_FACE, cullface);
+    state.SetEnabled(GL_TEXTURE_2D, textured);
 
-    if (hasTexture && textureId != 0) {
-        glEnable(GL_TEXTURE_2D);
-        glBindTexture(GL_TEXTURE_2D, textureId);
-    }
-
-    glBindBuffer(GL_ARRAY_BUFFER, verticesId);
-    glVertexPointer(3, GL_FLOAT, 0, NULL);
+    if (textured)
+        state.BindTexture(textureId);
 
-    glBindBuffer(GL_ARRAY_BUFFER, normalsId);
-    glNormalPointer(GL_FLOAT, 0, NULL);
+    app->renderer3D->geometryArena.BindFixedFunction(state);
+    glDrawElementsBaseVertex(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT,
+        (void*)(sizeof(uint32_t) * allocation.firstIndex), allocation.baseVertex);
 
-    glBindBuffer(GL_ARRAY_BUFFER, texCoordsId);
-    glTexCoordPointer(2, GL_FLOAT, 0, NULL);
-
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indicesId);
-    glDrawElements(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT, NULL);
+    return true;
+}
 
-    if (hasTexture && textureId != 0) {
-        glBindTexture(GL_TEXTURE_2D, 0);
-        glDisable(GL_TEXTURE_2D);
+bool Mesh::DrawMeshInstanced(uint instanceCount, uint textureId, bool hasTexture, bool wireframe, bool cullface)
+{
+    if (!initialized || !CheckMeshData()) {
+        LOG(LogType::LOG_ERROR, "Cannot draw mesh: Mesh not initialized or invalid data");
+        return false;
     }
 
-    glDisableClientState(GL_VERTEX_ARRAY);
-    glDisableClientState(GL_NORMAL_ARRAY);
-    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    GLStateCache& state = app->renderer3D->glState;
+
+    state.PolygonMode(wireframe ? GL_LINE : GL_FILL);
+    state.SetEnabled(GL_CULL_FACE, cullface);
 
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+    if (hasTexture && textureId != 0)
+        state.BindTexture(textureId);
 
-    if (wireframe)
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    // The per-instance matrix is bound by the renderer before this call
+    app->renderer3D->geometryArena.BindAttributes(state);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, indicesCount, GL_UNSIGNED_INT,
+        (void*)(sizeof(uint32_t) * allocation.firstIndex), instanceCount, allocation.baseVertex);
 
     return true;
 }
@@ -205,80 +192,129 @@ bool Mesh::DrawNormals(bool vertexNormals, bool faceNormals, float normalLength,
         return false;
     }
 
-    glDisable(GL_LIGHTING);
-    glDisable(GL_TEXTURE_2D);
+    GLStateCache& state = app->renderer3D->glState;
+
+    state.UseProgram(0);
+    state.SetEnabled(GL_LIGHTING, false);
+    state.SetEnabled(GL_TEXTURE_2D, false);
+    state.PolygonMode(GL_FILL);
+
+    for (GLuint attribute = 0; attribute < GL_STATE_ATTRIBUTES; ++attribute)
+        state.SetVertexAttribArray(attribute, false);
+
+    state.SetClientState(GL_VERTEX_ARRAY, true);
+    state.SetClientState(GL_NORMAL_ARRAY, false);
+    state.SetClientState(GL_TEXTURE_COORD_ARRAY, false);
+    state.InvalidateVertexLayout();
 
     // Draw vertex normals
     if (vertexNormals)
     {
-        glBegin(GL_LINES);
-        glColor3f(vertexNormalColor.x, vertexNormalColor.y, vertexNormalColor.z);
+        if (vertexNormalLinesId == 0 || vertexNormalLinesLength != normalLength)
+            BuildVertexNormalLines(normalLength);
 
-        for (uint i = 0; i < verticesCount; i++)
-        {
-            glVertex3f(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
-            glVertex3f(
-                vertices[i * 3] + normals[i * 3] * normalLength,
-                vertices[i * 3 + 1] + normals[i * 3 + 1] * normalLength,
-                vertices[i * 3 + 2] + normals[i * 3 + 2] * normalLength
-            );
-        }
-        glEnd();
+        glColor3f(vertexNormalColor.x, vertexNormalColor.y, vertexNormalColor.z);
+        state.BindBuffer(GL_ARRAY_BUFFER, vertexNormalLinesId);
+        glVertexPointer(3, GL_FLOAT, 0, NULL);
+        glDrawArrays(GL_LINES, 0, verticesCount * 2);
     }
 
     // Draw face normals
     if (faceNormals)
     {
-        glBegin(GL_LINES);
-        glColor3f(faceNormalColor.x, faceNormalColor.y, faceNormalColor.z);
+        if (faceNormalLinesId == 0 || faceNormalLinesLength != faceNormalLength)
+            BuildFaceNormalLines(faceNormalLength);
 
-        for (uint i = 0; i < indicesCount; i += 3)
-        {
-            // Calculate face center and normal
-            glm::vec3 v1(vertices[indices[i] * 3], vertices[indices[i] * 3 + 1], vertices[indices[i] * 3 + 2]);
-            glm::vec3 v2(vertices[indices[i + 1] * 3], vertices[indices[i + 1] * 3 + 1], vertices[indices[i + 1] * 3 + 2]);
-            glm::vec3 v3(vertices[indices[i + 2] * 3], vertices[indices[i + 2] * 3 + 1], vertices[indices[i + 2] * 3 + 2]);
-
-            glm::vec3 center = (v1 + v2 + v3) / 3.0f;
-
-            glm::vec3 edge1 = v2 - v1;
-            glm::vec3 edge2 = v3 - v1;
-            glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
-
-            glVertex3f(center.x, center.y, center.z);
-            glVertex3f(
-                center.x + normal.x * faceNormalLength,
-                center.y + normal.y * faceNormalLength,
-                center.z + normal.z * faceNormalLength
-            );
-        }
-        glEnd();
+        glColor3f(faceNormalColor.x, faceNormalColor.y, faceNormalColor.z);
+        state.BindBuffer(GL_ARRAY_BUFFER, faceNormalLinesId);
+        glVertexPointer(3, GL_FLOAT, 0, NULL);
+        glDrawArrays(GL_LINES, 0, (indicesCount / 3) * 2);
     }
 
-    glEnable(GL_LIGHTING);
+    // No lights are ever set up, the scene is drawn unlit
+    state.SetEnabled(GL_LIGHTING, false);
     glColor3f(1.0f, 1.0f, 1.0f); // Reset color
     return true;
 }
 
-void Mesh::CleanUp()
+void Mesh::BuildVertexNormalLines(float normalLength)
 {
-    if (verticesId != 0) {
-        glDeleteBuffers(1, &verticesId);
-        verticesId = 0;
+    std::vector<glm::vec3> lines;
+    lines.reserve(verticesCount * 2);
+
+    for (uint i = 0; i < verticesCount; i++)
+    {
+        glm::vec3 vertex(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+        glm::vec3 normal(normals[i * 3], normals[i * 3 + 1], normals[i * 3 + 2]);
+
+        lines.push_back(vertex);
+        lines.push_back(vertex + normal * normalLength);
     }
-    if (indicesId != 0) {
-        glDeleteBuffers(1, &indicesId);
-        indicesId = 0;
+
+    if (vertexNormalLinesId == 0)
+        glGenBuffers(1, &vertexNormalLinesId);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vertexNormalLinesId);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(glm::vec3) * lines.size(), lines.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    vertexNormalLinesLength = normalLength;
+}
+
+void Mesh::BuildFaceNormalLines(float faceNormalLength)
+{
+    std::vector<glm::vec3> lines;
+    lines.reserve((indicesCount / 3) * 2);
+
+    for (uint i = 0; i + 2 < indicesCount; i += 3)
+    {
+        // Calculate face center and normal
+        glm::vec3 v1(vertices[indices[i] * 3], vertices[indices[i] * 3 + 1], vertices[indices[i] * 3 + 2]);
+        glm::vec3 v2(vertices[indices[i + 1] * 3], vertices[indices[i + 1] * 3 + 1], vertices[indices[i + 1] * 3 + 2]);
+        glm::vec3 v3(vertices[indices[i + 2] * 3], vertices[indices[i + 2] * 3 + 1], vertices[indices[i + 2] * 3 + 2]);
+
+        glm::vec3 center = (v1 + v2 + v3) / 3.0f;
+
+        glm::vec3 edge1 = v2 - v1;
+        glm::vec3 edge2 = v3 - v1;
+        glm::vec3 normal = glm::normalize(glm::cross(edge1, edge2));
+
+        lines.push_back(center);
+        lines.push_back(center + normal * faceNormalLength);
     }
-    if (normalsId != 0) {
-        glDeleteBuffers(1, &normalsId);
-        normalsId = 0;
+
+    if (faceNormalLinesId == 0)
+        glGenBuffers(1, &faceNormalLinesId);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, faceNormalLinesId);
+    glBufferData(GL_COPY_WRITE_BUFFER, sizeof(glm::vec3) * lines.size(), lines.data(), GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    faceNormalLinesLength = faceNormalLength;
+}
+
+void Mesh::ReleaseNormalLines()
+{
+    if (vertexNormalLinesId != 0) {
+        glDeleteBuffers(1, &vertexNormalLinesId);
+        vertexNormalLinesId = 0;
     }
-    if (texCoordsId != 0) {
-        glDeleteBuffers(1, &texCoordsId);
-        texCoordsId = 0;
+    if (faceNormalLinesId != 0) {
+        glDeleteBuffers(1, &faceNormalLinesId);
+        faceNormalLinesId = 0;
     }
 
+    vertexNormalLinesLength = -1.0f;
+    faceNormalLinesLength = -1.0f;
+}
+
+void Mesh::CleanUp()
+{
+    GLContextLock lock(app->renderer3D->renderThread);
+
+    ReleaseGeometry();
+    ReleaseNormalLines();
+
     delete[] vertices;
     delete[] indices;
     delete[] normals;
@@ -303,6 +339,25 @@ bool Mesh::IsValid() const
     return initialized && CheckMeshData();
 }
 
+void Mesh::ReleaseGeometry()
+{
+    if (allocation.IsValid() && app != nullptr && app->renderer3D != nullptr)
+        app->renderer3D->geometryArena.Free(allocation);
+}
+
+void Mesh::ComputeBounds()
+{
+    aabbMin = glm::vec3(vertices[0], vertices[1], vertices[2]);
+    aabbMax = aabbMin;
+
+    for (uint i = 1; i < verticesCount; i++)
+    {
+        glm::vec3 vertex(vertices[i * 3], vertices[i * 3 + 1], vertices[i * 3 + 2]);
+        aabbMin = glm::min(aabbMin, vertex);
+        aabbMax = glm::max(aabbMax, vertex);
+    }
+}
+
 bool Mesh::CheckMeshData() const
 {
     return vertices != nullptr && indices != nullptr &&
@@ -2,6 +2,7 @@
 #include <string>
 #include <glm/glm.hpp>
 #include "Logger.h"
+#include "GeometryArena.h"
 
 typedef unsigned int uint;
 
@@ -22,10 +23,12 @@ public:
     uint normalsCount;
     uint texCoordsCount;
 
-    uint verticesId;
-    uint indicesId;
-    uint normalsId;
-    uint texCoordsId;
+    // Range inside the renderer's shared geometry arena
+    GeometryAllocation allocation;
+
+    // Local space bounds
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
 
     // Material properties
     glm::vec4 diffuseColor;
@@ -33,9 +36,13 @@ public:
     glm::vec4 ambientColor;
     std::string diffuseTexturePath;
 
+    // The file it was read from, what scenes refer to it by
+    std::string libraryFilePath;
+
     // Public methods
     bool InitMesh();
     bool DrawMesh(uint textureId = 0, bool hasTexture = false, bool wireframe = false, bool cullface = true);
+    bool DrawMeshInstanced(uint instanceCount, uint textureId = 0, bool hasTexture = false, bool wireframe = false, bool cullface = true);
     bool DrawNormals(bool vertexNormals = true, bool faceNormals = false,
         float normalLength = 0.5f, float faceNormalLength = 0.5f,
         const glm::vec3& vertexNormalColor = glm::vec3(1, 1, 0),
@@ -53,4 +60,15 @@ private:
     bool initialized;
     bool CheckMeshData() const;
     void ResetMesh();
+    void ReleaseGeometry();
+    void ComputeBounds();
+    void BuildVertexNormalLines(float normalLength);
+    void BuildFaceNormalLines(float faceNormalLength);
+    void ReleaseNormalLines();
+
+    // Debug normal lines, regenerated only when the mesh or the line length changes
+    uint vertexNormalLinesId = 0;
+    uint faceNormalLinesId = 0;
+    float vertexNormalLinesLength = -1.0f;
+    float faceNormalLinesLength = -1.0f;
 };
\ No newline at end of file
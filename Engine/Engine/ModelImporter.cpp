@@ -266,7 +266,27 @@ void ModelImporter::SaveMeshToCustomFile(aiMesh* newMesh, const aiScene* scene,
     }
 }
 
-Mesh* ModelImporter::LoadMeshFromCustomFile(const std::string& filePath)
+std::vector<Mesh*> ModelImporter::LoadMeshes(const std::vector<std::string>& filePaths)
+{
+    // Los ficheros se leen en paralelo, los buffers de GL se crean despues en este hilo
+    std::vector<Mesh*> meshes(filePaths.size(), nullptr);
+    app->jobs->ParallelFor((int)filePaths.size(), [this, &filePaths, &meshes](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            meshes[i] = ReadMeshFromCustomFile(filePaths[i]);
+        }
+    });
+
+    for (Mesh*& mesh : meshes) {
+        if (mesh && !(mesh->InitMesh() && mesh->IsValid())) {
+            delete mesh;
+            mesh = nullptr;
+        }
+    }
+
+    return meshes;
+}
+
+Mesh* ModelImporter::ReadMeshFromCustomFile(const std::string& filePath)
 {
     LOG(LogType::LOG_INFO, "Attempting to load mesh from: %s", filePath.c_str());
 
@@ -287,6 +307,7 @@ Mesh* ModelImporter::LoadMeshFromCustomFile(const std::string& filePath)
         if (!mesh) {
             throw std::runtime_error("Failed to allocate memory for mesh");
         }
+        mesh->libraryFilePath = filePath;
 
         // Leer rangos
         uint32_t ranges[4] = { 0, 0, 0, 0 };
@@ -361,12 +382,7 @@ Mesh* ModelImporter::LoadMeshFromCustomFile(const std::string& filePath)
 
         meshFile.close();
 
-        // Inicializar mesh
-        if (!mesh->InitMesh()) {
-            throw std::runtime_error("Failed to initialize mesh");
-        }
-
-        LOG(LogType::LOG_INFO, "Mesh loaded successfully: %s", filePath.c_str());
+        LOG(LogType::LOG_INFO, "Mesh read successfully: %s", filePath.c_str());
         return mesh;
     }
     catch (const std::exception& e) {
@@ -479,8 +495,8 @@ void ModelImporter::LoadModelFromCustomFile(const std::string& filePath, GameObj
 
         LOG(LogType::LOG_INFO, "Model contains %d meshes", numMeshes);
 
-        // Cargar meshes
-        std::vector<Mesh*> meshes;
+        // Leer paths de los meshes
+        std::vector<std::string> meshPaths;
         for (uint32_t i = 0; i < numMeshes && currentPos < buffer.size(); i++) {
             // Leer longitud del path
             uint32_t pathLength = 0;
@@ -495,20 +511,20 @@ void ModelImporter::LoadModelFromCustomFile(const std::string& filePath, GameObj
                 break;
             }
 
-            std::string meshPath(buffer.data() + currentPos, pathLength);
+            meshPaths.emplace_back(buffer.data() + currentPos, pathLength);
             currentPos += pathLength + 1;
+        }
 
-            LOG(LogType::LOG_INFO, "Loading mesh %d/%d: %s", i + 1, numMeshes, meshPath.c_str());
-
-            // Cargar mesh desde archivo
-            Mesh* mesh = LoadMeshFromCustomFile(meshPath);
-            if (mesh && mesh->IsValid()) {
-                meshes.push_back(mesh);
-                LOG(LogType::LOG_INFO, "Successfully loaded mesh %d/%d", i + 1, numMeshes);
+        // Cargar meshes
+        std::vector<Mesh*> loadedMeshes = LoadMeshes(meshPaths);
+        std::vector<Mesh*> meshes;
+        for (size_t i = 0; i < loadedMeshes.size(); i++) {
+            if (loadedMeshes[i]) {
+                meshes.push_back(loadedMeshes[i]);
+                LOG(LogType::LOG_INFO, "Successfully loaded mesh %d/%d: %s", (int)i + 1, numMeshes, meshPaths[i].c_str());
             }
             else {
-                LOG(LogType::LOG_ERROR, "Failed to load mesh %d/%d", i + 1, numMeshes);
-                delete mesh;
+                LOG(LogType::LOG_ERROR, "Failed to load mesh %d/%d: %s", (int)i + 1, numMeshes, meshPaths[i].c_str());
             }
         }
 
@@ -551,7 +567,7 @@ void ModelImporter::LoadNodeFromBuffer(const char* buffer, size_t& currentPos, s
     GameObject* gameObjectNode = nullptr;
     if (numMeshes > 0)
     {
-        gameObjectNode = new GameObject(nodeName.c_str(), parent);
+        gameObjectNode = app->scene->CreateGameObject(nodeName.c_str(), parent);
 
         // Process meshes
         for (uint32_t i = 0; i < numMeshes; i++)
@@ -562,8 +578,8 @@ void ModelImporter::LoadNodeFromBuffer(const char* buffer, size_t& currentPos, s
 
             if (meshIndex < meshes.size())
             {
-                ComponentMesh* componentMesh = dynamic_cast<ComponentMesh*>(gameObjectNode->AddComponent(gameObjectNode->mesh));
-                componentMesh->mesh = meshes[meshIndex];
+                gameObjectNode->AddComponent(ComponentType::MESH);
+                gameObjectNode->mesh->SetMesh(meshes[meshIndex]);
 
                 if (!meshes[meshIndex]->diffuseTexturePath.empty())
                 {
@@ -572,12 +588,10 @@ void ModelImporter::LoadNodeFromBuffer(const char* buffer, size_t& currentPos, s
                     Resource* newResource = app->resources->FindResourceInLibrary(meshes[meshIndex]->diffuseTexturePath, resourceType);
                     Texture* newTexture = app->importer->textureImporter->LoadTextureImage(newResource);
                     if (newTexture != nullptr)
-                        gameObjectNode->material->AddTexture(newTexture);
+                        ComponentMaterial::AddTexture(gameObjectNode, newTexture);
                 }
             }
         }
-
-        parent->children.push_back(gameObjectNode);
     }
 
     uint32_t numChildren;
@@ -587,9 +601,7 @@ void ModelImporter::LoadNodeFromBuffer(const char* buffer, size_t& currentPos, s
     // Processs children nodes
     if (numChildren > 0)
     {
-        GameObject* holder = gameObjectNode ? gameObjectNode : new GameObject(fileName, parent);
-        if (!gameObjectNode)
-            parent->children.push_back(holder);
+        GameObject* holder = gameObjectNode ? gameObjectNode : app->scene->CreateGameObject(fileName, parent);
 
         for (uint32_t i = 0; i < numChildren; i++)
         {
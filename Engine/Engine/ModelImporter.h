@@ -21,6 +21,8 @@ public:
     // Main public interface
     bool SaveModel(Resource* resource);
     bool LoadModel(Resource* resource, GameObject* root);
+    // Reads the files in parallel and creates the GL buffers on this thread, null where one failed
+    std::vector<Mesh*> LoadMeshes(const std::vector<std::string>& filePaths);
 
 private:
     // Model saving functions
@@ -33,7 +35,8 @@ private:
     void LoadNodeFromBuffer(const char* buffer, size_t& currentPos,
         std::vector<Mesh*>& meshes, GameObject* parent,
         const char* fileName);
-    Mesh* LoadMeshFromCustomFile(const std::string& filePath);
+    // Only reads the file, safe on any thread. The GL buffers are made later with InitMesh
+    Mesh* ReadMeshFromCustomFile(const std::string& filePath);
 
     // Utility functions
     size_t CalculateNodeSize(const aiNode* node);
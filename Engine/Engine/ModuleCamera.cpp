@@ -184,14 +184,16 @@ void ModuleCamera::RotateCamera(int dx, int dy)
 
 void ModuleCamera::FrameSelected()
 {
-	if (app->editor->selectedGameObject)
+	if (GameObject* selectedGameObject = app->editor->GetSelectedGameObject())
 	{
+		glm::vec3 position = selectedGameObject->transform->GetPosition();
+
 		pos = glm::vec3(
-			app->editor->selectedGameObject->transform->position.x,
-			app->editor->selectedGameObject->transform->position.y + 5.0f,
-			app->editor->selectedGameObject->transform->position.z + 5.0f
+			position.x,
+			position.y + 5.0f,
+			position.z + 5.0f
 		);
-		ref = app->editor->selectedGameObject->transform->position;
+		ref = position;
 		LookAt(ref);
 	}
 	else
@@ -213,6 +215,12 @@ void ModuleCamera::LookAt(const glm::vec3& spot)
 	CalculateViewMatrix();
 }
 
+void ModuleCamera::SetPosition(const glm::vec3& position)
+{
+	pos = position;
+	LookAt(ref);
+}
+
 const glm::mat4& ModuleCamera::GetViewMatrix() const
 {
 	return viewMatrix;
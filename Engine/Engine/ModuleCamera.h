@@ -20,6 +20,7 @@ public:
 	bool CleanUp();
 
 	void LookAt(const glm::vec3& spot);
+	void SetPosition(const glm::vec3& position);
 	const glm::mat4& GetViewMatrix() const;
 	glm::mat4 GetProjectionMatrix() const;
 
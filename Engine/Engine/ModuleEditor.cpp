@@ -1,5 +1,6 @@
 #include "ModuleEditor.h"
 #include "App.h"
+#include "Timer.h"
 
 #include "imgui_internal.h"
 
@@ -20,21 +21,28 @@ bool ModuleEditor::Awake()
 	LOG(LogType::LOG_INFO, "ModuleEditor");
 	bool ret = true;
 
-	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
+	// Headless runs keep the windows for their settings but never create an ImGui context
+	if (!app->IsHeadless())
+	{
+		IMGUI_CHECKVERSION();
+		ImGui::CreateContext();
+
+		ImGuiIO& io = ImGui::GetIO();
 
-	ImGuiIO& io = ImGui::GetIO();
+		ImFont* customFont = io.Fonts->AddFontFromFileTTF("Engine/Fonts/Roboto-Regular.ttf", 14.f);
+		if (customFont != nullptr)
+			io.FontDefault = customFont;
 
-	ImFont* customFont = io.Fonts->AddFontFromFileTTF("Engine/Fonts/Roboto-Regular.ttf", 14.f);
-	if (customFont != nullptr)
-		io.FontDefault = customFont;
+		io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
 
-	io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+		ApplyStyle();
 
-	ApplyStyle();
+		ImGui_ImplSDL2_InitForOpenGL(app->window->window, app->window->context);
+		ImGui_ImplOpenGL3_Init();
 
-	ImGui_ImplSDL2_InitForOpenGL(app->window->window, app->window->context);
-	ImGui_ImplOpenGL3_Init();
+		// Builds the font atlas now, NewFrame runs on the main thread which may not hold the context later
+		ImGui_ImplOpenGL3_CreateDeviceObjects();
+	}
 
 	hierarchyWindow = new HierarchyWindow(WindowType::HIERARCHY, "Hierarchy");
 	editorWindows.push_back(hierarchyWindow);
@@ -58,6 +66,9 @@ bool ModuleEditor::CleanUp()
 {
 	LOG(LogType::LOG_INFO, "Cleaning ModuleEditor");
 
+	if (app->IsHeadless())
+		return true;
+
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplSDL2_Shutdown();
 	ImGui::DestroyContext();
@@ -65,9 +76,10 @@ bool ModuleEditor::CleanUp()
 	return true;
 }
 
-void ModuleEditor::DrawEditor()
+void ModuleEditor::BuildEditor()
 {
-	ImGui_ImplOpenGL3_NewFrame();
+	Timer buildTimer;
+
 	ImGui_ImplSDL2_NewFrame();
 	ImGui::NewFrame();
 
@@ -77,6 +89,8 @@ void ModuleEditor::DrawEditor()
 	// Docking
 	Docking();
 
+	performanceWindow->UpdateInstancingBenchmark();
+
 	// Draw windows
 	for (const auto& editorWindow : editorWindows)
 	{
@@ -102,7 +116,57 @@ void ModuleEditor::DrawEditor()
 
 	ImGui::Render();
 
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	buildMs = (float)buildTimer.ReadMs();
+}
+
+ImDrawData* ModuleEditor::GetDrawData()
+{
+	return ImGui::GetDrawData();
+}
+
+void ModuleEditor::RenderDrawData(ImDrawData* drawData)
+{
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplOpenGL3_RenderDrawData(drawData);
+}
+
+ImDrawData* ModuleEditor::CaptureDrawData(ImDrawData*& snapshot)
+{
+	ReleaseDrawData(snapshot);
+
+	ImDrawData* source = ImGui::GetDrawData();
+	if (source == nullptr)
+		return nullptr;
+
+	snapshot = IM_NEW(ImDrawData)();
+	*snapshot = *source;
+
+	for (int i = 0; i < snapshot->CmdLists.Size; ++i)
+		snapshot->CmdLists[i] = source->CmdLists[i]->CloneOutput();
+
+	return snapshot;
+}
+
+void ModuleEditor::ReleaseDrawData(ImDrawData*& snapshot)
+{
+	if (snapshot == nullptr)
+		return;
+
+	for (ImDrawList* drawList : snapshot->CmdLists)
+		IM_DELETE(drawList);
+
+	IM_DELETE(snapshot);
+	snapshot = nullptr;
+}
+
+GameObject* ModuleEditor::GetSelectedGameObject() const
+{
+	return app->scene->GetGameObject(selectedGameObject);
+}
+
+void ModuleEditor::SetSelectedGameObject(GameObject* gameObject)
+{
+	selectedGameObject = app->scene->GetHandle(gameObject);
 }
 
 void ModuleEditor::Docking()
@@ -136,6 +200,19 @@ void ModuleEditor::MainMenuBar()
 
 	if (ImGui::BeginMenu("File"))
 	{
+		if (ImGui::MenuItem("Save Scene"))
+		{
+			app->scene->SaveScene("Assets/Scenes/" + app->scene->root->name + ".scene");
+		}
+		if (ImGui::MenuItem("Load Scene"))
+		{
+			std::string filePath = app->fileSystem->OpenFileDialog("Scene Files (*.scene)\0*.scene\0\0");
+			if (!filePath.empty())
+			{
+				app->scene->LoadScene(filePath);
+			}
+		}
+		ImGui::Separator();
 		if (ImGui::MenuItem("Exit", "Alt+F4"))
 		{
 			app->exit = true;
@@ -163,8 +240,7 @@ void ModuleEditor::MainMenuBar()
 	{
 		if (ImGui::MenuItem("Create Empty"))
 		{
-			app->scene->CreateGameObject("GameObject", app->scene->root);
-			selectedGameObject = app->scene->root->children.back();
+			SetSelectedGameObject(app->scene->CreateGameObject("GameObject", app->scene->root));
 		}
 		if (ImGui::BeginMenu("3D Object"))
 		{
@@ -184,7 +260,7 @@ void ModuleEditor::MainMenuBar()
 
 					app->importer->modelImporter->LoadModel(resource, app->scene->root);
 
-					selectedGameObject = app->scene->root->children.back();
+					SetSelectedGameObject(app->scene->root->children.back());
 				}
 			}
 
@@ -226,6 +302,40 @@ void ModuleEditor::MainMenuBar()
 		ImGui::EndMenu();
 	}
 
+	if (ImGui::BeginMenu("Benchmark"))
+	{
+		if (ImGui::MenuItem("10k Cubes (Instancing)"))
+		{
+			SetSelectedGameObject(app->scene->CreateInstancingBenchmark(10000));
+		}
+
+		if (ImGui::BeginMenu("Stress Scene"))
+		{
+			if (ImGui::InputInt("Objects", &stressSettings.objects, 1000, 100000) && stressSettings.objects < 1)
+				stressSettings.objects = 1;
+			ImGui::SliderInt("Depth", &stressSettings.depth, 1, 16);
+			ImGui::SliderInt("Branching", &stressSettings.branching, 1, 256);
+			ImGui::SliderFloat("Meshes", &stressSettings.meshRatio, 0.0f, 1.0f);
+			ImGui::SliderInt("Mesh Kinds", &stressSettings.meshKinds, 1, STRESS_PRIMITIVE_COUNT);
+			ImGui::SliderInt("Textures", &stressSettings.textures, 0, 64);
+			ImGui::SliderFloat("Static", &stressSettings.staticRatio, 0.0f, 1.0f);
+			ImGui::InputInt("Seed", &stressSettings.seed);
+
+			if (ImGui::MenuItem("Generate"))
+			{
+				SetSelectedGameObject(app->scene->CreateStressScene(stressSettings));
+			}
+			ImGui::EndMenu();
+		}
+
+		// With the stress scene settings, the object count is set by each step
+		if (ImGui::MenuItem("Scene Scaling (1k to 1M)", nullptr, false, !app->scene->scaleBenchmark.IsRunning()))
+		{
+			app->scene->scaleBenchmark.Start(stressSettings, SCALE_BENCHMARK_MAX_OBJECTS, "scale_benchmark.csv");
+		}
+		ImGui::EndMenu();
+	}
+
 	ImGui::EndMainMenuBar();
 }
 
@@ -2,6 +2,7 @@
 
 #include "Module.h"
 #include "GameObject.h"
+#include "SceneGenerator.h"
 #include "EditorWindow.h"
 
 #include "ConsoleWindow.h"
@@ -27,13 +28,27 @@ public:
 	bool Awake();
 	bool CleanUp();
 
-	void DrawEditor();
+	// Builds the UI on the main thread, drawing it is GL work and happens with the frame
+	void BuildEditor();
+	ImDrawData* GetDrawData();
+	void RenderDrawData(ImDrawData* drawData);
+
+	// Deep copy for the render thread, ImGui reuses its own draw lists on the next NewFrame
+	ImDrawData* CaptureDrawData(ImDrawData*& snapshot);
+	void ReleaseDrawData(ImDrawData*& snapshot);
+
 	void Docking();
 	void MainMenuBar();
 	void ApplyStyle();
 
+	// Null when nothing is selected or the selected object has been destroyed since
+	GameObject* GetSelectedGameObject() const;
+	void SetSelectedGameObject(GameObject* gameObject);
+
 public:
-	GameObject* selectedGameObject = nullptr;
+
+	// Time spent building the UI last frame, drawing it is measured on the GPU side
+	float buildMs = 0.0f;
 
 	ConsoleWindow* consoleWindow = nullptr;
 	HierarchyWindow* hierarchyWindow = nullptr;
@@ -48,4 +63,10 @@ public:
 private:
 
 	std::list<EditorWindow*> editorWindows;
+
+	// A handle, deleting the object from anywhere can't leave the selection dangling
+	GameObjectHandle selectedGameObject;
+
+	// Benchmark menu settings for generated scenes
+	StressSceneSettings stressSettings;
 };
\ No newline at end of file
@@ -9,6 +9,7 @@ ModuleFileSystem::ModuleFileSystem(App* app) : Module(app)
 	std::filesystem::create_directories("Library/Textures");
 	std::filesystem::create_directories("Library/Meshes");
 	std::filesystem::create_directories("Library/Models");
+	std::filesystem::create_directories("Library/Shaders");
 }
 
 ModuleFileSystem::~ModuleFileSystem()
@@ -0,0 +1,170 @@
+#include "ModuleHeadless.h"
+#include "App.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+ModuleHeadless::ModuleHeadless(App* app, const HeadlessSettings& settings) : Module(app), settings(settings)
+{
+}
+
+ModuleHeadless::~ModuleHeadless()
+{
+}
+
+bool ModuleHeadless::Start()
+{
+	LOG(LogType::LOG_INFO, "Headless run: %d frames at %dx%d", settings.frames, settings.width, settings.height);
+
+	if (settings.instances > 0)
+		app->scene->CreateInstancingBenchmark(settings.instances);
+
+	if (settings.stressScene)
+		app->scene->CreateStressScene(settings.stress);
+
+	if (settings.scaleBenchmark)
+		app->scene->scaleBenchmark.Start(settings.stress, settings.scaleMaxObjects, settings.scaleTimingsPath);
+
+	// A fixed resolution keeps runs comparable
+	app->renderer3D->dynamicResolution = false;
+
+	timingsFile.open(settings.timingsPath, std::ios::trunc);
+	if (!timingsFile.is_open())
+	{
+		LOG(LogType::LOG_ERROR, "Headless run: cannot write timings to %s", settings.timingsPath.c_str());
+		return false;
+	}
+
+	timingsFile << "frame,frame_ms,extraction_ms,scene_ms,culling_ms,draw_calls,objects";
+	for (int i = 0; i < (int)GpuStage::COUNT; ++i)
+		timingsFile << ",gpu_" << GpuProfiler::GetStageName((GpuStage)i) << "_ms";
+	timingsFile << "\n";
+
+	frameTimes.reserve(settings.frames);
+
+	return true;
+}
+
+bool ModuleHeadless::PreUpdate(float dt)
+{
+	// Fed every frame like the Scene panel does, so the render target settles at this size
+	app->renderer3D->SetSceneViewportSize(settings.width, settings.height);
+
+	MoveCamera();
+
+	return true;
+}
+
+bool ModuleHeadless::PostUpdate(float dt)
+{
+	// Runs after the renderer, the frame is complete and its stats are still in place
+	float frameMs = (float)frameTimer.ReadMs();
+	frameTimer.Start();
+
+	// Once the transforms have settled, before any timed frame
+	if (frame == HEADLESS_WARMUP_FRAMES && settings.extractionScaling)
+	{
+		app->renderer3D->RunExtractionBenchmark();
+		frameTimer.Start();
+	}
+
+	if (frame == HEADLESS_WARMUP_FRAMES && settings.jobBenchmark)
+	{
+		app->jobs->RunBenchmark();
+		frameTimer.Start();
+	}
+
+	if (frame >= HEADLESS_WARMUP_FRAMES)
+		RecordFrame(frameMs);
+
+	++frame;
+
+	bool done = settings.scaleBenchmark ? !app->scene->scaleBenchmark.IsRunning() : frame == HEADLESS_WARMUP_FRAMES + settings.frames;
+
+	if (done)
+	{
+		Finish();
+		app->exit = true;
+	}
+
+	return true;
+}
+
+bool ModuleHeadless::CleanUp()
+{
+	if (timingsFile.is_open())
+		timingsFile.close();
+
+	return true;
+}
+
+void ModuleHeadless::RecordFrame(float frameMs)
+{
+	const RenderStats& stats = app->renderer3D->renderStats;
+	const GpuProfiler& profiler = app->renderer3D->gpuProfiler;
+
+	frameTimes.push_back(frameMs);
+
+	timingsFile << frame - HEADLESS_WARMUP_FRAMES << "," << frameMs << "," << stats.extractionMs << "," << stats.sceneMs << "," << stats.cullingMs
+		<< "," << stats.drawCalls << "," << stats.objects;
+
+	// GPU results lag a frame or two behind, the columns hold the latest resolved value
+	for (int i = 0; i < (int)GpuStage::COUNT; ++i)
+		timingsFile << "," << profiler.GetTimings((GpuStage)i).lastMs;
+
+	timingsFile << "\n";
+}
+
+void ModuleHeadless::MoveCamera()
+{
+	// One full orbit over the whole run, the same path every time
+	float t = (float)frame / (float)(HEADLESS_WARMUP_FRAMES + settings.frames);
+	float angle = glm::radians(360.0f) * t;
+
+	glm::vec3 target(0.0f, 0.0f, 0.0f);
+	app->camera->SetPosition(target + glm::vec3(std::cos(angle) * HEADLESS_ORBIT_RADIUS, HEADLESS_ORBIT_HEIGHT, std::sin(angle) * HEADLESS_ORBIT_RADIUS));
+	app->camera->LookAt(target);
+}
+
+void ModuleHeadless::Finish()
+{
+	if (!settings.imagePath.empty())
+	{
+		if (app->renderer3D->SaveSceneImage(settings.imagePath))
+			LOG(LogType::LOG_INFO, "Headless run: final frame saved to %s", settings.imagePath.c_str());
+	}
+
+	// The same columns as the scale benchmark's CSV, one line per size
+	if (settings.scaleBenchmark)
+	{
+		for (const ScaleBenchmarkStep& step : app->scene->scaleBenchmark.GetSteps())
+		{
+			printf("objects=%d generate_ms=%.3f frame_ms=%.3f transform_ms=%.3f extraction_ms=%.3f culling_ms=%.3f submission_ms=%.3f imgui_ms=%.3f draw_calls=%d visible_objects=%d\n",
+				step.objects, step.generateMs, step.frameMs, step.transformMs, step.extractionMs, step.cullingMs,
+				step.submissionMs, step.imguiMs, step.drawCalls, step.visibleObjects);
+		}
+	}
+
+	if (frameTimes.empty())
+		return;
+
+	std::vector<float> sorted = frameTimes;
+	std::sort(sorted.begin(), sorted.end());
+
+	float total = 0.0f;
+	for (float ms : sorted)
+		total += ms;
+
+	float average = total / sorted.size();
+	float p95 = sorted[(size_t)((sorted.size() - 1) * 0.95f)];
+
+	LOG(LogType::LOG_INFO, "Headless run: avg %.3f ms, min %.3f ms, max %.3f ms, p95 %.3f ms over %d frames",
+		average, sorted.front(), sorted.back(), p95, (int)sorted.size());
+
+	// Also on stdout so CI jobs can grep the summary without reading the console window
+	printf("frames=%d avg_ms=%.3f min_ms=%.3f max_ms=%.3f p95_ms=%.3f\n",
+		(int)sorted.size(), average, sorted.front(), sorted.back(), p95);
+
+	timingsFile.flush();
+}
\ No newline at end of file
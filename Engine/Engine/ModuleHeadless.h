@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Module.h"
+#include "Timer.h"
+#include "ScaleBenchmark.h"
+
+#include <string>
+#include <vector>
+#include <fstream>
+
+#define HEADLESS_DEFAULT_FRAMES 300
+#define HEADLESS_DEFAULT_WIDTH 1280
+#define HEADLESS_DEFAULT_HEIGHT 720
+// Covers the render target settling at the requested size before anything is recorded
+#define HEADLESS_WARMUP_FRAMES 16
+#define HEADLESS_ORBIT_RADIUS 30.0f
+#define HEADLESS_ORBIT_HEIGHT 10.0f
+
+// Filled from the command line, see App::ParseCommandLine
+struct HeadlessSettings
+{
+	int frames = HEADLESS_DEFAULT_FRAMES;
+	int width = HEADLESS_DEFAULT_WIDTH;
+	int height = HEADLESS_DEFAULT_HEIGHT;
+	int instances = 0;
+	std::string timingsPath = "headless_timings.csv";
+	std::string imagePath;
+	bool extractionScaling = false;
+	bool jobBenchmark = false;
+	// Generated before the first frame when stressScene is set, also the shape of the scale benchmark scenes
+	StressSceneSettings stress;
+	bool stressScene = false;
+	// Runs until the scale benchmark is done instead of for a fixed number of frames
+	bool scaleBenchmark = false;
+	int scaleMaxObjects = SCALE_BENCHMARK_MAX_OBJECTS;
+	std::string scaleTimingsPath = "scale_benchmark.csv";
+};
+
+// Drives an unattended benchmark run: the camera orbits the scene for a fixed number of frames,
+// per-frame timings go to a CSV file and the last frame can be saved as an image
+class ModuleHeadless : public Module
+{
+public:
+	ModuleHeadless(App* app, const HeadlessSettings& settings);
+	virtual ~ModuleHeadless();
+
+	bool Start();
+	bool PreUpdate(float dt);
+	bool PostUpdate(float dt);
+	bool CleanUp();
+
+public:
+	HeadlessSettings settings;
+
+private:
+	void RecordFrame(float frameMs);
+	void MoveCamera();
+	void Finish();
+
+private:
+	int frame = 0;
+	std::ofstream timingsFile;
+	std::vector<float> frameTimes;
+	Timer frameTimer;
+};
\ No newline at end of file
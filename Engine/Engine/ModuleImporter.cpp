@@ -113,9 +113,10 @@ void ModuleImporter::LoadToScene(Resource* newResource, ResourceType resourceTyp
 		break;
 	case ResourceType::TEXTURE:
 		Texture* newTexture = textureImporter->LoadTextureImage(newResource);
-		if (newTexture && app->editor->selectedGameObject)
+		GameObject* selectedGameObject = app->editor->GetSelectedGameObject();
+		if (newTexture && selectedGameObject)
 		{
-			app->editor->selectedGameObject->material->AddTexture(newTexture);
+			ComponentMaterial::AddTexture(selectedGameObject, newTexture);
 		}
 		break;
 	}
@@ -87,7 +87,8 @@ bool ModuleInput::PreUpdate(float dt)
 	SDL_Event e;
 	while (SDL_PollEvent(&e))
 	{
-		ImGui_ImplSDL2_ProcessEvent(&e);
+		if (!app->IsHeadless())
+			ImGui_ImplSDL2_ProcessEvent(&e);
 
 		switch (e.type)
 		{
@@ -0,0 +1,321 @@
+#include "ModuleJobs.h"
+#include "Logger.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	// Which deque the current thread pushes to and pops from, 0 outside the pool
+	thread_local int workerIndex = 0;
+
+	float BenchmarkWork(int seed, int iterations)
+	{
+		float value = (float)seed;
+		for (int i = 0; i < iterations; ++i)
+			value = std::sqrt(value * 1.0001f + (float)i);
+
+		return value;
+	}
+}
+
+ModuleJobs::ModuleJobs(App* app) : Module(app)
+{
+	queues.push_back(std::make_unique<WorkerQueue>());
+}
+
+ModuleJobs::~ModuleJobs()
+{
+	StopThreads();
+}
+
+bool ModuleJobs::Awake()
+{
+	StartThreads();
+	return true;
+}
+
+bool ModuleJobs::PreUpdate(float dt)
+{
+	uint64_t executed = executedJobs.load(std::memory_order_relaxed);
+	uint64_t stolen = stolenJobs.load(std::memory_order_relaxed);
+
+	frameJobs = (int)(executed - lastExecutedJobs);
+	frameSteals = (int)(stolen - lastStolenJobs);
+
+	lastExecutedJobs = executed;
+	lastStolenJobs = stolen;
+
+	return true;
+}
+
+bool ModuleJobs::CleanUp()
+{
+	StopThreads();
+	return true;
+}
+
+void ModuleJobs::StartThreads(int threadCount)
+{
+	StopThreads();
+
+	if (threadCount <= 0)
+		threadCount = std::max(1, (int)std::thread::hardware_concurrency() - 1);
+
+	quit = false;
+
+	for (int i = 1; i <= threadCount; ++i)
+		queues.push_back(std::make_unique<WorkerQueue>());
+
+	for (int i = 1; i <= threadCount; ++i)
+		threads.emplace_back(&ModuleJobs::WorkerLoop, this, i);
+
+	LOG(LogType::LOG_INFO, "Job system started with %d worker threads", threadCount);
+}
+
+void ModuleJobs::StopThreads()
+{
+	if (threads.empty())
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		quit = true;
+	}
+	wake.notify_all();
+
+	for (std::thread& thread : threads)
+		thread.join();
+
+	threads.clear();
+
+	// Whatever the workers left behind still runs, on whoever waits for it
+	WorkerQueue& shared = *queues[0];
+	for (size_t i = 1; i < queues.size(); ++i)
+	{
+		for (Job& job : queues[i]->jobs)
+			shared.jobs.push_back(std::move(job));
+	}
+
+	queues.resize(1);
+}
+
+void ModuleJobs::Run(std::function<void()> function, JobCounter* counter, JobCounter* dependency)
+{
+	Job job;
+	job.function = std::move(function);
+	job.counter = counter;
+
+	if (counter != nullptr)
+		counter->pending.fetch_add(1, std::memory_order_relaxed);
+
+	if (dependency != nullptr)
+	{
+		// Checked under the lock so it can't reach zero between the check and parking the job
+		std::lock_guard<std::mutex> lock(dependency->mutex);
+		if (!dependency->IsDone())
+		{
+			dependency->continuations.push_back(std::move(job));
+			return;
+		}
+	}
+
+	Push(std::move(job));
+}
+
+void ModuleJobs::Wait(JobCounter& counter)
+{
+	const int index = workerIndex;
+
+	while (!counter.IsDone())
+	{
+		if (!TryRunJob(index))
+			std::this_thread::yield();
+	}
+
+	// The last job may still be releasing the counter, it can't be destroyed before that
+	std::lock_guard<std::mutex> lock(counter.mutex);
+}
+
+void ModuleJobs::ParallelFor(int count, const std::function<void(int begin, int end)>& function, int batchSize)
+{
+	if (count <= 0)
+		return;
+
+	batchSize = std::max(1, batchSize);
+
+	if (threads.empty() || count <= batchSize)
+	{
+		function(0, count);
+		return;
+	}
+
+	JobCounter counter;
+
+	for (int begin = batchSize; begin < count; begin += batchSize)
+	{
+		int end = std::min(begin + batchSize, count);
+		Run([&function, begin, end]() { function(begin, end); }, &counter);
+	}
+
+	function(0, batchSize);
+
+	Wait(counter);
+}
+
+void ModuleJobs::WorkerLoop(int index)
+{
+	workerIndex = index;
+
+	while (!quit)
+	{
+		if (TryRunJob(index))
+			continue;
+
+		std::unique_lock<std::mutex> lock(sleepMutex);
+		wake.wait(lock, [this] { return quit || queuedJobs.load() > 0; });
+	}
+}
+
+void ModuleJobs::Push(Job&& job)
+{
+	WorkerQueue& queue = *queues[workerIndex < (int)queues.size() ? workerIndex : 0];
+
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back(std::move(job));
+	}
+
+	queuedJobs.fetch_add(1);
+
+	// Taking the lock orders this with a worker that is about to sleep, so the wake-up is not lost
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+bool ModuleJobs::TryRunJob(int index)
+{
+	Job job;
+	bool found = false;
+
+	const int queueCount = (int)queues.size();
+	if (index >= queueCount)
+		index = 0;
+
+	// Own deque from the back, newest first while its data is still in cache
+	{
+		WorkerQueue& queue = *queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.jobs.empty())
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			found = true;
+		}
+	}
+
+	// Others from the front, the oldest job is usually the largest piece left
+	for (int i = 1; i < queueCount && !found; ++i)
+	{
+		WorkerQueue& victim = *queues[(index + i) % queueCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.jobs.empty())
+		{
+			job = std::move(victim.jobs.front());
+			victim.jobs.pop_front();
+			found = true;
+			stolenJobs.fetch_add(1, std::memory_order_relaxed);
+		}
+	}
+
+	if (!found)
+		return false;
+
+	queuedJobs.fetch_sub(1);
+
+	job.function();
+	executedJobs.fetch_add(1, std::memory_order_relaxed);
+
+	if (job.counter != nullptr)
+		Finish(job.counter);
+
+	return true;
+}
+
+void ModuleJobs::Finish(JobCounter* counter)
+{
+	std::vector<Job> ready;
+
+	{
+		std::lock_guard<std::mutex> lock(counter->mutex);
+		if (counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			ready.swap(counter->continuations);
+	}
+
+	for (Job& job : ready)
+		Push(std::move(job));
+}
+
+void ModuleJobs::RunBenchmark()
+{
+	const int smallJobs = 100000;
+	const int smallWork = 16;
+	const int largeJobs = 256;
+	const int largeWork = 200000;
+
+	std::vector<float> serial(smallJobs);
+	std::vector<float> parallel(smallJobs);
+
+	LOG(LogType::LOG_INFO, "Job system benchmark, %d threads", GetThreadCount());
+
+	Timer timer;
+	for (int i = 0; i < smallJobs; ++i)
+		serial[i] = BenchmarkWork(i, smallWork);
+	double serialMs = timer.ReadMs();
+
+	// One job per item shows the scheduling cost, batching shows what parallel_for gets back
+	timer.Start();
+	JobCounter counter;
+	for (int i = 0; i < smallJobs; ++i)
+		Run([&parallel, i]() { parallel[i] = BenchmarkWork(i, smallWork); }, &counter);
+	Wait(counter);
+	double jobsMs = timer.ReadMs();
+	bool jobsMatch = serial == parallel;
+
+	std::fill(parallel.begin(), parallel.end(), 0.0f);
+
+	timer.Start();
+	ParallelFor(smallJobs, [&parallel](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				parallel[i] = BenchmarkWork(i, smallWork);
+		}, 1024);
+	double batchedMs = timer.ReadMs();
+	bool batchedMatch = serial == parallel;
+
+	LOG(LogType::LOG_INFO, "Small jobs (%d): serial %.2f ms, one job each %.2f ms (%.2f M jobs/s), batched %.2f ms (%.2fx), results %s",
+		smallJobs, serialMs, jobsMs, jobsMs > 0.0 ? smallJobs / (jobsMs * 1000.0) : 0.0,
+		batchedMs, batchedMs > 0.0 ? serialMs / batchedMs : 0.0, jobsMatch && batchedMatch ? "match" : "DIFFER");
+
+	serial.resize(largeJobs);
+	parallel.assign(largeJobs, 0.0f);
+
+	timer.Start();
+	for (int i = 0; i < largeJobs; ++i)
+		serial[i] = BenchmarkWork(i, largeWork);
+	serialMs = timer.ReadMs();
+
+	timer.Start();
+	ParallelFor(largeJobs, [&parallel](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				parallel[i] = BenchmarkWork(i, largeWork);
+		});
+	double largeMs = timer.ReadMs();
+
+	LOG(LogType::LOG_INFO, "Large jobs (%d): serial %.2f ms, jobs %.2f ms (%.2fx), results %s",
+		largeJobs, serialMs, largeMs, largeMs > 0.0 ? serialMs / largeMs : 0.0, serial == parallel ? "match" : "DIFFER");
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Module.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class JobCounter;
+
+struct Job
+{
+	std::function<void()> function;
+	JobCounter* counter = nullptr;
+};
+
+// Counts the unfinished jobs of a group. Jobs that depend on it are held here until it reaches zero.
+// It has to outlive the jobs counted on it, which ModuleJobs::Wait guarantees
+class JobCounter
+{
+public:
+	bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class ModuleJobs;
+
+	std::atomic<int> pending{ 0 };
+	std::mutex mutex;
+	std::vector<Job> continuations;
+};
+
+// Work-stealing pool shared by the whole engine. Every worker owns a deque, it takes its newest job
+// first and steals the oldest one of another deque when its own runs dry. Threads outside the pool
+// (main, render) share one extra deque, and any thread waiting on a counter runs jobs meanwhile, so
+// jobs can start and wait for more jobs. Needs nothing else from App, so it can run on its own
+class ModuleJobs : public Module
+{
+public:
+	ModuleJobs(App* app);
+	virtual ~ModuleJobs();
+
+	bool Awake();
+	bool PreUpdate(float dt);
+	bool CleanUp();
+
+	// 0 uses one thread per core minus the calling one
+	void StartThreads(int threadCount = 0);
+	void StopThreads();
+
+	// The counter goes up now and down when the job finishes. With a dependency the job is only
+	// queued once that counter reaches zero
+	void Run(std::function<void()> function, JobCounter* counter = nullptr, JobCounter* dependency = nullptr);
+	// Runs queued jobs on the calling thread until the counter reaches zero
+	void Wait(JobCounter& counter);
+
+	// Blocks until function has been called for every batch of [0, count), the first batch runs on the calling thread
+	void ParallelFor(int count, const std::function<void(int begin, int end)>& function, int batchSize = 1);
+
+	int GetThreadCount() const { return (int)threads.size() + 1; }
+
+	// Logs throughput of many tiny jobs and of a few heavy ones against running them serially
+	void RunBenchmark();
+
+public:
+	// Since the previous frame
+	int frameJobs = 0;
+	int frameSteals = 0;
+
+private:
+	struct WorkerQueue
+	{
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	void WorkerLoop(int index);
+	void Push(Job&& job);
+	bool TryRunJob(int index);
+	void Finish(JobCounter* counter);
+
+private:
+	std::vector<std::thread> threads;
+	// Index 0 is for threads outside the pool
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::atomic<int> queuedJobs{ 0 };
+	std::atomic<bool> quit{ false };
+
+	std::atomic<uint64_t> executedJobs{ 0 };
+	std::atomic<uint64_t> stolenJobs{ 0 };
+	uint64_t lastExecutedJobs = 0;
+	uint64_t lastStolenJobs = 0;
+};
\ No newline at end of file
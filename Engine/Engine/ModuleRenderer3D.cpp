@@ -10,8 +10,10 @@
 #include <IL/ilut.h>
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <cstring>
 
-ModuleRenderer3D::ModuleRenderer3D(App* app) : Module(app), rbo(0), fboTexture(0), fbo(0), checkerTextureId(0)
+ModuleRenderer3D::ModuleRenderer3D(App* app) : Module(app), rbo(0), fboTexture(0), fbo(0), checkerTextureId(0), instanceBuffer(0), indirectBuffer(0), viewProjection(1.0f), cameraPosition(0.0f)
 {
 }
 
@@ -82,6 +84,36 @@ bool ModuleRenderer3D::Awake()
         LOG(LogType::LOG_INFO, "OpenGL setup completed");
     }
 
+    shaderCache.Init();
+
+    LOG(LogType::LOG_INFO, "Loading instanced shader");
+    Timer shaderTimer;
+    if (!instancedShader.LoadFromFiles("Engine/Shaders/Instanced.vert", "Engine/Shaders/Instanced.frag", &shaderCache))
+    {
+        LOG(LogType::LOG_WARNING, "Instanced shader not available, repeated meshes will be drawn one by one");
+    }
+    shaderLoadMs = (float)shaderTimer.ReadMs();
+    LOG(LogType::LOG_INFO, "Instanced shader %s in %.2f ms", instancedShader.loadedFromCache ? "loaded from cache" : "compiled", shaderLoadMs);
+    glGenBuffers(1, &instanceBuffer);
+
+    LOG(LogType::LOG_INFO, "Creating geometry arena");
+    if (!geometryArena.Init(GEOMETRY_ARENA_VERTICES, GEOMETRY_ARENA_INDICES))
+    {
+        LOG(LogType::LOG_ERROR, "Error creating geometry arena");
+        ret = false;
+    }
+
+    streamBuffer.Init(STREAM_BUFFER_FRAME_SIZE);
+
+    // Every command after the first starts at its own baseInstance, which also needs base instance support
+    indirectSupported = (GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect) && (GLEW_VERSION_4_2 || GLEW_ARB_base_instance);
+    if (indirectSupported)
+        glGenBuffers(1, &indirectBuffer);
+    else
+        LOG(LogType::LOG_WARNING, "Multi-draw indirect with base instance not supported, falling back to per-mesh draws");
+
+    gpuProfiler.Init();
+
     LOG(LogType::LOG_INFO, "Creating checker texture");
     for (int i = 0; i < CHECKERS_HEIGHT; i++) {
         for (int j = 0; j < CHECKERS_WIDTH; j++) {
@@ -152,16 +184,15 @@ bool ModuleRenderer3D::Awake()
                             streetEnv->transform->SetTransformMatrix(
                                 initialPosition,
                                 initialRotation,
-                                initialScale,
-                                nullptr
+                                initialScale
                             );
 
-                            // Asegurar que la transformacin se actualiza
-                            streetEnv->transform->updateTransform = true;
-                            streetEnv->transform->UpdateTransform();
+                            // Street geometry never moves, let the renderer batch it
+                            streetEnv->SetStatic(true);
+                            staticBatcher.MarkDirty();
                         }
 
-                        app->editor->selectedGameObject = streetEnv;
+                        app->editor->SetSelectedGameObject(streetEnv);
                         LOG(LogType::LOG_INFO, "Scene hierarchy set up successfully");
                     }
                 }
@@ -179,6 +210,8 @@ bool ModuleRenderer3D::Awake()
     }
 
     LOG(LogType::LOG_INFO, "Creating framebuffer");
+    sceneWidth = fboWidth = SCREEN_WIDTH;
+    sceneHeight = fboHeight = SCREEN_HEIGHT;
     CreateFramebuffer();
 
     LOG(LogType::LOG_INFO, "Setting up screen size");
@@ -190,78 +223,244 @@ bool ModuleRenderer3D::Awake()
 
 bool ModuleRenderer3D::PreUpdate(float dt)
 {
-	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	frameTimer.Start();
 
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
+	// Only CPU state is prepared here, GL work happens when the frame is executed
+	RenderFrame& frame = frames[writeFrame];
 
-	glm::mat4 projectionMatrix = app->camera->GetProjectionMatrix();
-	glLoadMatrixf(glm::value_ptr(projectionMatrix));
+	frame.projection = app->camera->GetProjectionMatrix();
+	frame.view = app->camera->GetViewMatrix();
+	frame.viewProjection = frame.projection * frame.view;
+	frame.cameraPosition = glm::vec3(glm::inverse(frame.view)[3]);
+	frame.frustum.Update(frame.viewProjection);
 
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	// Static objects changed, so did the occluder set
+	if (staticBatcher.IsDirty())
+		occlusionCuller.MarkDirty();
 
-	glm::mat4 viewMatrix = app->camera->GetViewMatrix();
-	glLoadMatrixf(glm::value_ptr(viewMatrix));
+	bool rebuildBatches = (useStaticBatching && staticBatcher.IsDirty())
+		|| (!useStaticBatching && (!staticBatcher.IsEmpty() || staticBatcher.IsDirty()));
+	bool collectOccluders = useOcclusionCulling && occlusionCuller.IsDirty();
+
+	if (rebuildBatches || collectOccluders)
+	{
+		// Both are read while a frame renders, so the render thread has to be idle
+		GLContextLock lock(renderThread);
+
+		// Both bake world matrices, which are otherwise only refreshed in the scene update
+		app->scene->transforms.Update(*app->jobs);
+
+		// Rebuilt before the scene update so meshes know whether they are batched this frame
+		if (useStaticBatching && staticBatcher.IsDirty())
+			staticBatcher.Build(app->scene->root);
+		else if (!useStaticBatching && (!staticBatcher.IsEmpty() || staticBatcher.IsDirty()))
+			staticBatcher.Clear(app->scene->root);
+
+		if (useOcclusionCulling && occlusionCuller.IsDirty())
+			occlusionCuller.CollectOccluders(app->scene->root);
+	}
 
 	return true;
 }
 
 bool ModuleRenderer3D::PostUpdate(float dt)
 {
-	grid.Render();
+	RenderFrame& frame = frames[writeFrame];
+	frame.settings = CaptureSettings();
+
+	// Transforms are final once the scene has updated, the draw list is recorded from them here
+	sceneExtractor.Extract(app->scene->entities, app->scene->transforms, frame.settings.frustumCulling ? &frame.frustum : nullptr, *app->jobs, frame.packets);
+	frame.objects = sceneExtractor.objects;
+	frame.culledObjects = sceneExtractor.culledObjects;
+	frame.extractionMs = sceneExtractor.extractionMs;
+	frame.windowWidth = app->window->width;
+	frame.windowHeight = app->window->height;
+	frame.uiData = nullptr;
+
+	// Headless runs have no editor, the scene target is the output
+	if (!app->IsHeadless())
+		app->editor->BuildEditor();
+
+	if (renderThread.IsRunning())
+	{
+		if (!app->IsHeadless())
+			frame.uiData = app->editor->CaptureDrawData(frame.uiSnapshot);
+
+		// Frame N-1 has to be out before N is handed over, this is the only place the main thread waits
+		mainWaitMs = (float)renderThread.WaitIdle();
+		PublishFrameResults();
+
+		renderThread.Kick(writeFrame);
+		writeFrame = (writeFrame + 1) % RENDER_FRAME_BUFFERS;
+	}
+	else
+	{
+		if (!app->IsHeadless())
+			frame.uiData = app->editor->GetDrawData();
+
+		mainWaitMs = 0.0f;
+		ExecuteFrame(frame);
+		PublishFrameResults();
+	}
+
+	// Measured before the swap so vsync waits do not count as work
+	frameWorkMs = frameWorkMs * 0.9f + (float)frameTimer.ReadMs() * 0.1f;
+	UpdateDynamicResolution();
+
+	// Applied between frames so a frame never starts on one thread and ends on the other
+	if (useRenderThread != renderThread.IsRunning())
+		SetRenderThreadRunning(useRenderThread);
+
+	return true;
+}
+
+void ModuleRenderer3D::ExecuteFrame(RenderFrame& frame)
+{
+	Timer submitTimer;
+
+	frameStats = RenderStats();
+	frameStats.objects = frame.objects;
+	frameStats.culledObjects = frame.culledObjects;
+	frameStats.extractionMs = frame.extractionMs;
+
+	// The frame's packets become the render side list, the emptied one goes back for reuse
+	std::swap(drawPackets, frame.packets);
+	settings = frame.settings;
+	viewProjection = frame.viewProjection;
+	cameraPosition = frame.cameraPosition;
+	frustum = frame.frustum;
+
+	glState.enabled = settings.stateCache;
+	gpuProfiler.enabled = settings.gpuTimers;
+
+	gpuProfiler.BeginFrame();
+	streamBuffer.BeginFrame();
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, fboWidth, fboHeight);
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glMatrixMode(GL_PROJECTION);
+	glLoadMatrixf(glm::value_ptr(frame.projection));
+
+	glMatrixMode(GL_MODELVIEW);
+	glLoadMatrixf(glm::value_ptr(frame.view));
+
+	DrawScene();
+
+	gpuProfiler.Begin(GpuStage::GRID);
+	grid.Render(glState);
+	gpuProfiler.End(GpuStage::GRID);
+
+	ResetSceneState();
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, frame.windowWidth, frame.windowHeight);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-	app->editor->DrawEditor();
+	if (frame.uiData != nullptr)
+	{
+		gpuProfiler.Begin(GpuStage::IMGUI);
+		app->editor->RenderDrawData(frame.uiData);
+		gpuProfiler.End(GpuStage::IMGUI);
+	}
+
+	gpuProfiler.EndFrame();
+	streamBuffer.EndFrame();
 
-	SDL_GL_SwapWindow(app->window->window);
+	frameStats.streamedBytes = (int)streamBuffer.bytesStreamed;
+	frameStats.streamOverflows = streamBuffer.overflows;
+	frameStats.fenceStalls = streamBuffer.fenceStalls;
+	frameStats.fenceStallMs = streamBuffer.fenceStallMs;
 
-	return true;
+	// Only NVIDIA drivers answer, others leave the values at 0
+	glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &frameStats.gpuMemoryTotalKb);
+	glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &frameStats.gpuMemoryAvailableKb);
+
+	frameStats.submitMs = (float)submitTimer.ReadMs();
+
+	if (!app->IsHeadless())
+		SDL_GL_SwapWindow(app->window->window);
 }
 
-bool ModuleRenderer3D::CleanUp()
+void ModuleRenderer3D::PublishFrameResults()
 {
-	LOG(LogType::LOG_INFO, "Destroying 3D Renderer");
+	// Runs on the main thread while no frame is executing
+	renderStats = frameStats;
+	renderStats.mainWaitMs = mainWaitMs;
+	renderStats.renderThread = renderThread.IsRunning();
 
-	glDeleteFramebuffers(1, &fbo);
-	glDeleteTextures(1, &fboTexture);
-	glDeleteRenderbuffers(1, &rbo);
+	glState.EndFrame();
+	gpuProfiler.Publish();
+}
 
-	return true;
+RenderSettings ModuleRenderer3D::CaptureSettings() const
+{
+	const PreferencesWindow* preferences = app->editor->preferencesWindow;
+
+	RenderSettings captured;
+	captured.drawTextures = preferences->drawTextures;
+	captured.wireframe = preferences->wireframe;
+	captured.shadedWireframe = preferences->shadedWireframe;
+	captured.cullFace = preferences->cullFace;
+	captured.vertexNormalLength = preferences->vertexNormalLength;
+	captured.faceNormalLength = preferences->faceNormalLength;
+	captured.vertexNormalColor = preferences->vertexNormalColor;
+	captured.faceNormalColor = preferences->faceNormalColor;
+	captured.frustumCulling = useFrustumCulling;
+	captured.occlusionCulling = useOcclusionCulling;
+	captured.instancing = useInstancing;
+	captured.instancingThreshold = instancingThreshold;
+	captured.indirectDraw = useIndirectDraw;
+	captured.stateCache = useGLStateCache;
+	captured.gpuTimers = useGpuTimers;
+
+	return captured;
 }
 
-void ModuleRenderer3D::OnResize(int width, int height)
+void ModuleRenderer3D::SetRenderThreadRunning(bool run)
 {
-	glViewport(0, 0, width, height);
+	if (!run)
+	{
+		renderThread.Stop();
+		return;
+	}
 
-	app->camera->screenWidth = width;
-	app->camera->screenHeight = height;
+	if (!renderThread.Start(app->window->window, app->window->context, [this](int frame) { ExecuteFrame(frames[frame]); }))
+		useRenderThread = false;
+}
 
-	app->window->width = width;
-	app->window->height = height;
+bool ModuleRenderer3D::CleanUp()
+{
+	LOG(LogType::LOG_INFO, "Destroying 3D Renderer");
 
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
+	// Every GL object below belongs to the context, take it back first
+	renderThread.Stop();
 
-	glm::mat4 projectionMatrix = app->camera->GetProjectionMatrix();
-	glLoadMatrixf(glm::value_ptr(projectionMatrix));
+	for (RenderFrame& frame : frames)
+		app->editor->ReleaseDrawData(frame.uiSnapshot);
 
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	DeleteFramebuffer();
 
-	if (fbo > 0)
-		glDeleteFramebuffers(1, &fbo);
+	instancedShader.CleanUp();
+	glDeleteBuffers(1, &instanceBuffer);
+	glDeleteBuffers(1, &indirectBuffer);
 
-	if (fboTexture > 0)
-		glDeleteTextures(1, &fboTexture);
+	staticBatcher.Clear(app->scene->root);
+	geometryArena.CleanUp();
+	streamBuffer.CleanUp();
+	grid.CleanUp();
+	gpuProfiler.CleanUp();
 
-	if (rbo > 0)
-		glDeleteRenderbuffers(1, &rbo);
+	return true;
+}
 
-	CreateFramebuffer();
+void ModuleRenderer3D::OnResize(int width, int height)
+{
+	// Only the editor UI follows the OS window, the scene target follows the Scene panel.
+	// The viewport itself is set when the frame executes, possibly on the render thread
+	app->window->width = width;
+	app->window->height = height;
 }
 
 void ModuleRenderer3D::CreateFramebuffer()
@@ -273,13 +472,13 @@ void ModuleRenderer3D::CreateFramebuffer()
 	glBindTexture(GL_TEXTURE_2D, fboTexture);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, app->window->width, app->window->height, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, fboWidth, fboHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
 	glBindTexture(GL_TEXTURE_2D, 0);
 	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, fboTexture, 0);
 
 	glGenRenderbuffers(1, &rbo);
 	glBindRenderbuffer(GL_RENDERBUFFER, rbo);
-	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, app->window->width, app->window->height);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, fboWidth, fboHeight);
 	glBindRenderbuffer(GL_RENDERBUFFER, 0);
 	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
 
@@ -288,4 +487,515 @@ void ModuleRenderer3D::CreateFramebuffer()
 	}
 
 	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void ModuleRenderer3D::DeleteFramebuffer()
+{
+	if (fbo > 0)
+		glDeleteFramebuffers(1, &fbo);
+
+	if (fboTexture > 0)
+		glDeleteTextures(1, &fboTexture);
+
+	if (rbo > 0)
+		glDeleteRenderbuffers(1, &rbo);
+
+	fbo = 0;
+	fboTexture = 0;
+	rbo = 0;
+}
+
+bool ModuleRenderer3D::SaveSceneImage(const std::string& filePath)
+{
+	std::vector<GLubyte> pixels((size_t)fboWidth * fboHeight * 4);
+
+	GLContextLock lock(renderThread);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, fboWidth, fboHeight, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	// GL rows start at the bottom, as does DevIL's default origin
+	ILuint image;
+	ilGenImages(1, &image);
+	ilBindImage(image);
+	ilTexImage(fboWidth, fboHeight, 1, 4, IL_RGBA, IL_UNSIGNED_BYTE, pixels.data());
+	ilEnable(IL_FILE_OVERWRITE);
+
+	bool saved = ilSaveImage(filePath.c_str()) == IL_TRUE;
+	if (!saved)
+		LOG(LogType::LOG_ERROR, "Failed to save scene image to %s: %s", filePath.c_str(), iluErrorString(ilGetError()));
+
+	ilDeleteImages(1, &image);
+
+	return saved;
+}
+
+void ModuleRenderer3D::SetSceneViewportSize(int width, int height)
+{
+	if (width <= 0 || height <= 0)
+		return;
+
+	// Wait until the panel keeps the same size for a few frames before reallocating
+	if (width != requestedWidth || height != requestedHeight)
+	{
+		requestedWidth = width;
+		requestedHeight = height;
+		settleFrames = 0;
+		return;
+	}
+
+	if (width == sceneWidth && height == sceneHeight)
+		return;
+
+	if (++settleFrames < SCENE_RESIZE_SETTLE_FRAMES)
+		return;
+
+	sceneWidth = width;
+	sceneHeight = height;
+
+	app->camera->screenWidth = width;
+	app->camera->screenHeight = height;
+
+	UpdateRenderTargetSize();
+}
+
+void ModuleRenderer3D::UpdateRenderTargetSize()
+{
+	int width = std::max(1, (int)(sceneWidth * renderScale));
+	int height = std::max(1, (int)(sceneHeight * renderScale));
+
+	if (width == fboWidth && height == fboHeight)
+		return;
+
+	// Waits for the frame in flight, it still draws into the old target
+	GLContextLock lock(renderThread);
+
+	fboWidth = width;
+	fboHeight = height;
+
+	DeleteFramebuffer();
+	CreateFramebuffer();
+}
+
+void ModuleRenderer3D::UpdateDynamicResolution()
+{
+	if (!dynamicResolution)
+	{
+		if (renderScale != 1.0f)
+		{
+			renderScale = 1.0f;
+			UpdateRenderTargetSize();
+		}
+		return;
+	}
+
+	// Give the smoothed frame time a chance to react before stepping again
+	if (resolutionCooldown > 0)
+	{
+		--resolutionCooldown;
+		return;
+	}
+
+	float scale = renderScale;
+
+	if (frameWorkMs > targetFrameMs * 1.05f)
+		scale -= DYNAMIC_RESOLUTION_STEP;
+	else if (frameWorkMs < targetFrameMs * 0.8f)
+		scale += DYNAMIC_RESOLUTION_STEP;
+
+	scale = glm::clamp(scale, minRenderScale, 1.0f);
+
+	if (std::fabs(scale - renderScale) > 0.001f)
+	{
+		renderScale = scale;
+		UpdateRenderTargetSize();
+		resolutionCooldown = DYNAMIC_RESOLUTION_COOLDOWN_FRAMES;
+	}
+}
+
+void ModuleRenderer3D::RunExtractionBenchmark()
+{
+	const int runs = 20;
+	const int maxThreads = app->jobs->GetThreadCount();
+	const int previousBatchCount = sceneExtractor.batchCount;
+
+	// Keeps the render thread from competing for the workers while measuring
+	renderThread.WaitIdle();
+
+	std::vector<DrawPacket> packets;
+	double singleThreadMs = 0.0;
+
+	LOG(LogType::LOG_INFO, "Extraction benchmark: %d mesh objects, %d runs per thread count", sceneExtractor.objects, runs);
+
+	for (int threads = 1; ; threads *= 2)
+	{
+		if (threads > maxThreads)
+			threads = maxThreads;
+
+		// One batch per thread means no more than that many threads can take part
+		sceneExtractor.batchCount = threads;
+		sceneExtractor.Extract(app->scene->entities, app->scene->transforms, &frames[writeFrame].frustum, *app->jobs, packets);
+
+		double totalMs = 0.0;
+		for (int i = 0; i < runs; ++i)
+		{
+			sceneExtractor.Extract(app->scene->entities, app->scene->transforms, &frames[writeFrame].frustum, *app->jobs, packets);
+			totalMs += sceneExtractor.extractionMs;
+		}
+
+		double averageMs = totalMs / runs;
+		if (threads == 1)
+			singleThreadMs = averageMs;
+
+		LOG(LogType::LOG_INFO, "Extraction with %d threads: %.3f ms (%.2fx), %d packets recorded", threads, averageMs,
+			averageMs > 0.0 ? singleThreadMs / averageMs : 0.0, (int)packets.size());
+
+		if (threads == maxThreads)
+			break;
+	}
+
+	sceneExtractor.batchCount = previousBatchCount;
+}
+
+void ModuleRenderer3D::DrawScene()
+{
+	Timer sceneTimer;
+	Timer cullingTimer;
+
+	if (settings.occlusionCulling)
+	{
+		Timer rasterTimer;
+		occlusionCuller.Render(viewProjection, cameraPosition, *app->jobs);
+		frameStats.occlusionRasterMs = (float)rasterTimer.ReadMs();
+		frameStats.occluders = occlusionCuller.renderedOccluders;
+		frameStats.occluderTriangles = occlusionCuller.rasterizedTriangles;
+	}
+
+	// Frustum culling already happened during extraction
+	if (settings.occlusionCulling)
+		CullPackets();
+
+	if (!staticBatcher.IsEmpty())
+		staticBatcher.Cull(frustum, settings.occlusionCulling ? &occlusionCuller : nullptr, *app->jobs);
+
+	frameStats.cullingMs = (float)cullingTimer.ReadMs();
+
+	// Whatever ran before the pass may have changed GL behind the cache's back
+	glState.BeginFrame();
+	glActiveTexture(GL_TEXTURE0);
+
+	gpuProfiler.Begin(GpuStage::SCENE);
+
+	if (!staticBatcher.IsEmpty())
+	{
+		frameStats.staticDrawCalls = staticBatcher.Draw(glState, settings.drawTextures, settings.wireframe, settings.cullFace);
+		frameStats.drawCalls += frameStats.staticDrawCalls;
+		frameStats.staticObjects = staticBatcher.batchedObjects;
+		frameStats.culledStaticObjects = staticBatcher.culledRanges;
+		frameStats.occludedStaticObjects = staticBatcher.occludedRanges;
+		frameStats.objects += frameStats.staticObjects;
+	}
+
+	// Packets arrive sorted from extraction and culling keeps their order, so runs of a mesh and texture are adjacent
+	size_t drawableCount = 0;
+	while (drawableCount < drawPackets.size() && !drawPackets[drawableCount].normalsOnly)
+		++drawableCount;
+
+	bool canInstance = settings.instancing && instancedShader.IsValid();
+
+	size_t first = 0;
+	if (canInstance && settings.indirectDraw && indirectSupported && drawableCount > 0)
+	{
+		DrawIndirect(drawableCount);
+		first = drawableCount;
+	}
+
+	while (first < drawableCount)
+	{
+		size_t last = first + 1;
+		while (last < drawableCount
+			&& drawPackets[last].mesh == drawPackets[first].mesh
+			&& drawPackets[last].textureId == drawPackets[first].textureId)
+		{
+			++last;
+		}
+
+		uint count = (uint)(last - first);
+
+		if (canInstance && count >= (uint)settings.instancingThreshold)
+		{
+			DrawInstanced(&drawPackets[first], count);
+		}
+		else
+		{
+			for (size_t i = first; i < last; ++i)
+				DrawSingle(drawPackets[i]);
+		}
+
+		first = last;
+	}
+
+	gpuProfiler.End(GpuStage::SCENE);
+
+	gpuProfiler.Begin(GpuStage::DEBUG_NORMALS);
+	DrawDebugNormals();
+	gpuProfiler.End(GpuStage::DEBUG_NORMALS);
+
+	drawPackets.clear();
+
+	frameStats.sceneMs = (float)sceneTimer.ReadMs();
+}
+
+void ModuleRenderer3D::ResetSceneState()
+{
+	// Leave GL as ImGui and the next frame's setup expect it. Lighting stays off, no lights are ever set
+	// up and the fixed-function draws have to match the unlit instanced path
+	glState.UseProgram(0);
+	glState.BindTexture(0);
+	glState.PolygonMode(GL_FILL);
+	glState.SetEnabled(GL_CULL_FACE, true);
+	glState.SetEnabled(GL_TEXTURE_2D, true);
+	glState.SetEnabled(GL_LIGHTING, false);
+
+	for (GLuint attribute = 0; attribute < GL_STATE_ATTRIBUTES; ++attribute)
+		glState.SetVertexAttribArray(attribute, false);
+
+	glState.SetClientState(GL_VERTEX_ARRAY, false);
+	glState.SetClientState(GL_NORMAL_ARRAY, false);
+	glState.SetClientState(GL_TEXTURE_COORD_ARRAY, false);
+
+	glState.BindBuffer(GL_ARRAY_BUFFER, 0);
+	glState.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	glState.BindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+void ModuleRenderer3D::CullPackets()
+{
+	packetCulling.resize(drawPackets.size());
+
+	app->jobs->ParallelFor((int)drawPackets.size(), [this](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+			{
+				const DrawPacket& packet = drawPackets[i];
+
+				if (!occlusionCuller.IsVisible(packet.mesh->aabbMin, packet.mesh->aabbMax, packet.transform))
+					packetCulling[i] = CullResult::OCCLUDED;
+				else
+					packetCulling[i] = CullResult::VISIBLE;
+			}
+		}, 256);
+
+	size_t kept = 0;
+	for (size_t i = 0; i < drawPackets.size(); ++i)
+	{
+		if (packetCulling[i] == CullResult::VISIBLE)
+		{
+			drawPackets[kept++] = drawPackets[i];
+			continue;
+		}
+
+		if (!drawPackets[i].normalsOnly)
+			frameStats.occludedObjects++;
+	}
+
+	drawPackets.resize(kept);
+}
+
+void ModuleRenderer3D::DrawIndirect(size_t count)
+{
+	// Packets are sorted by texture then mesh, so each mesh run becomes one command whose
+	// baseInstance points at its first transform and each texture run one multi-draw
+	instanceTransforms.resize(count);
+	indirectCommands.clear();
+
+	struct TextureRun
+	{
+		GLuint textureId;
+		size_t firstCommand;
+		size_t commandCount;
+	};
+	std::vector<TextureRun> textureRuns;
+
+	size_t first = 0;
+	while (first < count)
+	{
+		const DrawPacket& packet = drawPackets[first];
+
+		size_t last = first;
+		while (last < count && drawPackets[last].mesh == packet.mesh && drawPackets[last].textureId == packet.textureId)
+		{
+			instanceTransforms[last] = drawPackets[last].transform;
+			++last;
+		}
+
+		const GeometryAllocation& allocation = packet.mesh->allocation;
+
+		DrawElementsIndirectCommand command;
+		command.count = allocation.indexCount;
+		command.instanceCount = (GLuint)(last - first);
+		command.firstIndex = allocation.firstIndex;
+		command.baseVertex = (GLint)allocation.baseVertex;
+		command.baseInstance = (GLuint)first;
+
+		if (textureRuns.empty() || textureRuns.back().textureId != packet.textureId)
+			textureRuns.push_back({ packet.textureId, indirectCommands.size(), 0 });
+
+		indirectCommands.push_back(command);
+		textureRuns.back().commandCount++;
+
+		first = last;
+	}
+
+	BindInstanceTransforms(count);
+
+	GLsizeiptr commandsSize = sizeof(DrawElementsIndirectCommand) * indirectCommands.size();
+	GLintptr commandsOffset = 0;
+
+	StreamAllocation commands = streamBuffer.Allocate(commandsSize, sizeof(GLuint));
+	if (commands.IsValid())
+	{
+		memcpy(commands.data, indirectCommands.data(), commandsSize);
+		glState.BindBuffer(GL_DRAW_INDIRECT_BUFFER, streamBuffer.GetBuffer());
+		commandsOffset = commands.offset;
+	}
+	else
+	{
+		// Orphan last frame's storage so the driver does not wait on its draws
+		glState.BindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, commandsSize, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, commandsSize, indirectCommands.data());
+	}
+
+	geometryArena.BindAttributes(glState);
+
+	glState.PolygonMode(settings.wireframe ? GL_LINE : GL_FILL);
+	glState.SetEnabled(GL_CULL_FACE, settings.cullFace);
+
+	glState.UseProgram(instancedShader.programId);
+	instancedShader.SetMat4("viewProjection", viewProjection);
+	instancedShader.SetInt("diffuseTexture", 0);
+
+	for (const TextureRun& run : textureRuns)
+	{
+		bool textured = settings.drawTextures && IsTextured(run.textureId);
+
+		glState.BindTexture(textured ? run.textureId : 0);
+		instancedShader.SetInt("hasTexture", textured ? 1 : 0);
+
+		glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+			(void*)(commandsOffset + sizeof(DrawElementsIndirectCommand) * run.firstCommand), (GLsizei)run.commandCount, 0);
+
+		frameStats.drawCalls++;
+		frameStats.indirectDrawCalls++;
+	}
+
+	frameStats.indirectCommands += (int)indirectCommands.size();
+	frameStats.instances += (int)count;
+}
+
+void ModuleRenderer3D::DrawSingle(const DrawPacket& packet)
+{
+	glPushMatrix();
+	glMultMatrixf(glm::value_ptr(packet.transform));
+
+	packet.mesh->DrawMesh(
+		packet.textureId,
+		settings.drawTextures,
+		settings.wireframe,
+		settings.cullFace
+	);
+
+	glPopMatrix();
+
+	frameStats.drawCalls++;
+}
+
+void ModuleRenderer3D::DrawInstanced(const DrawPacket* packets, uint count)
+{
+	instanceTransforms.resize(count);
+	for (uint i = 0; i < count; ++i)
+		instanceTransforms[i] = packets[i].transform;
+
+	BindInstanceTransforms(count);
+
+	bool textured = settings.drawTextures && IsTextured(packets[0].textureId);
+
+	glState.UseProgram(instancedShader.programId);
+	instancedShader.SetMat4("viewProjection", viewProjection);
+	instancedShader.SetInt("diffuseTexture", 0);
+	instancedShader.SetInt("hasTexture", textured ? 1 : 0);
+
+	packets[0].mesh->DrawMeshInstanced(
+		count,
+		packets[0].textureId,
+		textured,
+		settings.wireframe,
+		settings.cullFace
+	);
+
+	frameStats.drawCalls++;
+	frameStats.instancedDrawCalls++;
+	frameStats.instances += count;
+}
+
+void ModuleRenderer3D::BindInstanceTransforms(size_t count)
+{
+	GLsizeiptr size = sizeof(glm::mat4) * count;
+	GLintptr offset = 0;
+
+	StreamAllocation allocation = streamBuffer.Allocate(size);
+	if (allocation.IsValid())
+	{
+		memcpy(allocation.data, instanceTransforms.data(), size);
+		glState.BindBuffer(GL_ARRAY_BUFFER, streamBuffer.GetBuffer());
+		offset = allocation.offset;
+	}
+	else
+	{
+		// Orphan the previous storage so the driver does not wait on last frame's draws
+		glState.BindBuffer(GL_ARRAY_BUFFER, instanceBuffer);
+		glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, size, instanceTransforms.data());
+	}
+
+	// Pointers are re-specified every time since the offset moves with each allocation
+	for (int column = 0; column < 4; ++column)
+	{
+		GLuint attribute = INSTANCE_TRANSFORM_ATTRIBUTE + column;
+		glState.SetVertexAttribArray(attribute, true);
+		glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), (void*)(offset + sizeof(glm::vec4) * column));
+		glVertexAttribDivisor(attribute, 1);
+	}
+}
+
+void ModuleRenderer3D::DrawDebugNormals()
+{
+	for (const DrawPacket& packet : drawPackets)
+	{
+		if (!packet.vertexNormals && !packet.faceNormals)
+			continue;
+
+		glPushMatrix();
+		glMultMatrixf(glm::value_ptr(packet.transform));
+
+		packet.mesh->DrawNormals(
+			packet.vertexNormals,
+			packet.faceNormals,
+			settings.vertexNormalLength,
+			settings.faceNormalLength,
+			settings.vertexNormalColor,
+			settings.faceNormalColor
+		);
+
+		glPopMatrix();
+	}
+}
+
+bool ModuleRenderer3D::IsTextured(GLuint textureId) const
+{
+	// Materials without a texture keep the -1 id they were created with
+	return textureId != 0 && textureId != (GLuint)-1;
 }
\ No newline at end of file
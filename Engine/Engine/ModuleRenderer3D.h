@@ -2,14 +2,129 @@
 
 #include "Module.h"
 #include "Grid.h"
+#include "Mesh.h"
+#include "Shader.h"
+#include "Frustum.h"
+#include "StaticBatcher.h"
+#include "GeometryArena.h"
+#include "OcclusionCuller.h"
+#include "SceneExtractor.h"
+#include "Timer.h"
+#include "GLStateCache.h"
+#include "ShaderCache.h"
+#include "GpuProfiler.h"
+#include "StreamBuffer.h"
+#include "RenderThread.h"
 
 #include <SDL2/SDL_video.h>
 #include <GL/glew.h>
+#include <glm/glm.hpp>
 #include <vector>
 
 #define CHECKERS_WIDTH 128*2
 #define CHECKERS_HEIGHT 128*2
 
+#define INSTANCE_TRANSFORM_ATTRIBUTE 4
+
+#define GEOMETRY_ARENA_VERTICES 262144
+#define GEOMETRY_ARENA_INDICES 1048576
+
+#define STREAM_BUFFER_FRAME_SIZE 4194304
+
+#define SCENE_RESIZE_SETTLE_FRAMES 8
+#define DYNAMIC_RESOLUTION_STEP 0.05f
+#define DYNAMIC_RESOLUTION_COOLDOWN_FRAMES 30
+
+#define RENDER_FRAME_BUFFERS 2
+
+struct ImDrawData;
+
+// Layout read by glMultiDrawElementsIndirect from GL_DRAW_INDIRECT_BUFFER
+struct DrawElementsIndirectCommand
+{
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;
+	GLint baseVertex;
+	GLuint baseInstance;
+};
+
+struct RenderStats
+{
+	int objects = 0;
+	int culledObjects = 0;
+	int occludedObjects = 0;
+	int occluders = 0;
+	int occluderTriangles = 0;
+	int drawCalls = 0;
+	int instancedDrawCalls = 0;
+	int instances = 0;
+	int indirectDrawCalls = 0;
+	int indirectCommands = 0;
+	int staticDrawCalls = 0;
+	int staticObjects = 0;
+	int culledStaticObjects = 0;
+	int occludedStaticObjects = 0;
+	float occlusionRasterMs = 0.0f;
+	float cullingMs = 0.0f;
+	float extractionMs = 0.0f;
+	float sceneMs = 0.0f;
+	float submitMs = 0.0f;
+	float mainWaitMs = 0.0f;
+	bool renderThread = false;
+	GLint gpuMemoryTotalKb = 0;
+	GLint gpuMemoryAvailableKb = 0;
+	int streamedBytes = 0;
+	int streamOverflows = 0;
+	int fenceStalls = 0;
+	float fenceStallMs = 0.0f;
+};
+
+// Everything a frame reads from the editor, copied when it is handed over so the UI can keep changing it
+struct RenderSettings
+{
+	bool drawTextures = true;
+	bool wireframe = false;
+	bool shadedWireframe = false;
+	bool cullFace = true;
+	float vertexNormalLength = 0.1f;
+	float faceNormalLength = 0.1f;
+	glm::vec3 vertexNormalColor = glm::vec3(0.0f, 1.0f, 0.0f);
+	glm::vec3 faceNormalColor = glm::vec3(1.0f, 0.0f, 0.0f);
+
+	bool frustumCulling = true;
+	bool occlusionCulling = true;
+	bool instancing = true;
+	int instancingThreshold = 2;
+	bool indirectDraw = true;
+	bool stateCache = true;
+	bool gpuTimers = true;
+};
+
+// One side of the double-buffered command list: the main thread fills one while the other is submitted
+struct RenderFrame
+{
+	// Recorded and frustum culled on the main thread, sorted by texture and mesh
+	std::vector<DrawPacket> packets;
+	int objects = 0;
+	int culledObjects = 0;
+	float extractionMs = 0.0f;
+
+	glm::mat4 projection = glm::mat4(1.0f);
+	glm::mat4 view = glm::mat4(1.0f);
+	glm::mat4 viewProjection = glm::mat4(1.0f);
+	glm::vec3 cameraPosition = glm::vec3(0.0f);
+	Frustum frustum;
+
+	RenderSettings settings;
+	int windowWidth = 0;
+	int windowHeight = 0;
+
+	// Points at uiSnapshot when the render thread is on, at ImGui's own draw data otherwise
+	ImDrawData* uiData = nullptr;
+	ImDrawData* uiSnapshot = nullptr;
+};
+
 class ModuleRenderer3D : public Module
 {
 public:
@@ -23,6 +138,31 @@ public:
 
 	void OnResize(int width, int height);
 	void CreateFramebuffer();
+	void SetSceneViewportSize(int width, int height);
+	bool SaveSceneImage(const std::string& filePath);
+
+	// Logs extraction time over the current scene with 1, 2, 4... threads up to the whole pool
+	void RunExtractionBenchmark();
+
+private:
+	void DeleteFramebuffer();
+	void UpdateRenderTargetSize();
+	void UpdateDynamicResolution();
+
+	void ExecuteFrame(RenderFrame& frame);
+	void PublishFrameResults();
+	RenderSettings CaptureSettings() const;
+	void SetRenderThreadRunning(bool run);
+
+	void DrawScene();
+	void ResetSceneState();
+	void CullPackets();
+	void DrawIndirect(size_t count);
+	void DrawSingle(const DrawPacket& packet);
+	void DrawInstanced(const DrawPacket* packets, uint count);
+	void BindInstanceTransforms(size_t count);
+	void DrawDebugNormals();
+	bool IsTextured(GLuint textureId) const;
 
 public:
 	GLubyte checkerImage[CHECKERS_WIDTH][CHECKERS_HEIGHT][4];
@@ -33,4 +173,85 @@ public:
 	GLuint fbo;
 	GLuint fboTexture;
 	GLuint rbo;
+
+	// The scene is rendered at the Scene panel size times renderScale, not at the OS window size
+	int sceneWidth = 0;
+	int sceneHeight = 0;
+	int fboWidth = 0;
+	int fboHeight = 0;
+
+	// Lowers renderScale while the frame takes longer than targetFrameMs and raises it back when there is headroom
+	bool dynamicResolution = false;
+	float targetFrameMs = 16.6f;
+	float minRenderScale = 0.5f;
+	float renderScale = 1.0f;
+	float frameWorkMs = 0.0f;
+
+	// Draws that share mesh and texture are merged into one instanced call
+	bool useInstancing = true;
+	int instancingThreshold = 2;
+
+	// Every GL state change of the scene pass goes through here
+	GLStateCache glState;
+	bool useGLStateCache = true;
+
+	ShaderCache shaderCache;
+	float shaderLoadMs = 0.0f;
+
+	GpuProfiler gpuProfiler;
+	bool useGpuTimers = true;
+
+	// Submits frame N on its own thread while the main thread simulates N+1.
+	// Main thread GL work has to hold a GLContextLock while it is on
+	bool useRenderThread = false;
+	RenderThread renderThread;
+
+	// Static objects are merged per texture into pre-transformed buffers
+	bool useStaticBatching = true;
+	StaticBatcher staticBatcher;
+
+	// Every mesh lives in these shared buffers, visible draws go out through multi-draw indirect
+	GeometryArena geometryArena;
+	bool useIndirectDraw = true;
+	bool indirectSupported = false;
+
+	// Per-frame data written straight into mapped memory, any render-side system can suballocate from it
+	StreamBuffer streamBuffer;
+
+	bool useFrustumCulling = true;
+	Frustum frustum;
+
+	// Large static meshes are rasterized on the CPU and hide what is behind them
+	bool useOcclusionCulling = true;
+	OcclusionCuller occlusionCuller;
+
+	// Records the frame's draw list on the job system
+	SceneExtractor sceneExtractor;
+
+	RenderStats renderStats;
+
+private:
+	RenderFrame frames[RENDER_FRAME_BUFFERS];
+	int writeFrame = 0;
+	float mainWaitMs = 0.0f;
+
+	// Render side state, only touched while a frame executes
+	RenderSettings settings;
+	RenderStats frameStats;
+	std::vector<DrawPacket> drawPackets;
+	std::vector<glm::mat4> instanceTransforms;
+	std::vector<DrawElementsIndirectCommand> indirectCommands;
+	std::vector<CullResult> packetCulling;
+
+	Shader instancedShader;
+	GLuint instanceBuffer;
+	GLuint indirectBuffer;
+	glm::mat4 viewProjection;
+	glm::vec3 cameraPosition;
+
+	int requestedWidth = 0;
+	int requestedHeight = 0;
+	int settleFrames = 0;
+	int resolutionCooldown = 0;
+	Timer frameTimer;
 };
\ No newline at end of file
@@ -1,5 +1,113 @@
 #include "ModuleScene.h"
 #include "App.h"
+#include "Timer.h"
+#include "SceneSerializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <random>
+
+namespace
+{
+	// Draw list recording done the object way: a recursive walk asking every GameObject for its components
+	void GatherFromTree(const GameObject* node, const TransformHierarchy& transforms, const Frustum& frustum, std::vector<DrawPacket>& packets)
+	{
+		if (!node->isActive)
+			return;
+
+		if (node->mesh != nullptr)
+		{
+			Mesh* mesh = node->mesh->GetMesh();
+			if (mesh != nullptr)
+			{
+				DrawPacket packet;
+				packet.mesh = mesh;
+				packet.textureId = ComponentMaterial::GetTextureId(node);
+				packet.transform = transforms.GetWorld(node->transform->id);
+
+				if (frustum.IntersectsAABB(mesh->aabbMin, mesh->aabbMax, packet.transform))
+					packets.push_back(packet);
+			}
+		}
+
+		for (const GameObject* child : node->children)
+			GatherFromTree(child, transforms, frustum, packets);
+	}
+
+	// The object layout before pooling, kept only as the allocation benchmark's baseline: every node and
+	// each of its three components a heap block of its own, all made up front whether used or not
+	struct LegacyComponent
+	{
+		LegacyComponent(void* owner, ComponentType type) : owner(owner), type(type) {}
+		virtual ~LegacyComponent() {}
+
+		bool active = true;
+		void* owner;
+		ComponentType type;
+	};
+
+	struct LegacyTransform : LegacyComponent
+	{
+		LegacyTransform(void* owner) : LegacyComponent(owner, ComponentType::TRANSFORM) {}
+
+		glm::mat4 localTransform = glm::mat4(1.0f);
+		glm::mat4 globalTransform = glm::mat4(1.0f);
+		glm::vec3 position = glm::vec3(0.0f);
+		glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+		glm::vec3 eulerRotation = glm::vec3(0.0f);
+		glm::vec3 scale = glm::vec3(1.0f);
+		bool constrainedProportions = false;
+		float initialScale[3] = { 1.0f, 1.0f, 1.0f };
+		bool updateTransform = false;
+	};
+
+	struct LegacyMesh : LegacyComponent
+	{
+		LegacyMesh(void* owner) : LegacyComponent(owner, ComponentType::MESH) {}
+
+		Mesh* mesh = nullptr;
+		bool showVertexNormals = false;
+		bool showFaceNormals = false;
+	};
+
+	struct LegacyMaterial : LegacyComponent
+	{
+		LegacyMaterial(void* owner) : LegacyComponent(owner, ComponentType::MATERIAL) {}
+
+		Texture* materialTexture = nullptr;
+		GLuint textureId = 0;
+		bool showCheckersTexture = false;
+	};
+
+	struct LegacyGameObject
+	{
+		LegacyGameObject(const char* name, LegacyGameObject* parent) : parent(parent), name(name)
+		{
+			transform = new LegacyTransform(this);
+			mesh = new LegacyMesh(this);
+			material = new LegacyMaterial(this);
+			components.push_back(transform);
+		}
+
+		virtual ~LegacyGameObject()
+		{
+			delete transform;
+			delete mesh;
+			delete material;
+		}
+
+		LegacyGameObject* parent;
+		std::string name;
+		LegacyTransform* transform;
+		LegacyMesh* mesh;
+		LegacyMaterial* material;
+		std::vector<LegacyComponent*> components;
+		std::vector<LegacyGameObject*> children;
+		bool isActive = true;
+		bool isEditing = false;
+	};
+}
 
 ModuleScene::ModuleScene(App* app) : Module(app), root(nullptr)
 {
@@ -18,7 +126,10 @@ bool ModuleScene::Awake()
 
 bool ModuleScene::Update(float dt)
 {
-	root->Update();
+	// World matrices are final before any component reads them
+	transforms.Update(*app->jobs);
+
+	scaleBenchmark.Update();
 
 	return true;
 }
@@ -27,14 +138,403 @@ bool ModuleScene::CleanUp()
 {
 	LOG(LogType::LOG_INFO, "Cleaning ModuleScene");
 
+	DestroyGameObject(root);
+	root = nullptr;
+
 	return true;
 }
 
 GameObject* ModuleScene::CreateGameObject(const char* name, GameObject* parent)
 {
-	GameObject* gameObject = new GameObject(name, parent);
+	return CreateGameObject(name, parent, 0);
+}
+
+GameObject* ModuleScene::CreateGameObject(const char* name, GameObject* parent, uint32_t components)
+{
+	GameObject* gameObject = gameObjects.Create(name, parent, components);
+
+	if (bulkCreating)
+		pendingNames.push_back(gameObjects.GetHandle(gameObject));
+	else
+		names.Add(gameObjects.GetHandle(gameObject), gameObject->name);
+
+	++hierarchyVersion;
 
 	if (parent != nullptr) parent->children.push_back(gameObject);
+	else gameObject->isExpanded = true;
 
 	return gameObject;
+}
+
+void ModuleScene::DestroyGameObject(GameObject* gameObject)
+{
+	if (gameObject == nullptr)
+		return;
+
+	if (gameObject->parent != nullptr)
+	{
+		// From the back, the newest children are the ones usually removed
+		std::vector<GameObject*>& siblings = gameObject->parent->children;
+		auto it = std::find(siblings.rbegin(), siblings.rend(), gameObject);
+		if (it != siblings.rend())
+			siblings.erase(std::next(it).base());
+	}
+
+	// Detached first so they don't unlink themselves from the vector being walked
+	std::vector<GameObject*> children;
+	children.swap(gameObject->children);
+
+	for (GameObject* child : children)
+	{
+		child->parent = nullptr;
+		DestroyGameObject(child);
+	}
+
+	// The batches and the occluders hold static meshes and transforms, whoever deleted the node
+	if (gameObject->isStatic)
+	{
+		app->renderer3D->staticBatcher.MarkDirty();
+		app->renderer3D->occlusionCuller.MarkDirty();
+	}
+
+	names.Remove(gameObjects.GetHandle(gameObject));
+	gameObjects.Destroy(gameObject);
+	++hierarchyVersion;
+}
+
+void ModuleScene::BeginBulkCreate()
+{
+	bulkCreating = true;
+	pendingNames.clear();
+}
+
+void ModuleScene::EndBulkCreate()
+{
+	bulkCreating = false;
+
+	std::vector<GameObjectHandle> handles;
+	std::vector<const std::string*> objectNames;
+	handles.reserve(pendingNames.size());
+	objectNames.reserve(pendingNames.size());
+
+	// Anything destroyed before the end is skipped, its name never went in
+	for (GameObjectHandle handle : pendingNames)
+	{
+		if (GameObject* gameObject = gameObjects.Get(handle))
+		{
+			handles.push_back(handle);
+			objectNames.push_back(&gameObject->name);
+		}
+	}
+
+	names.Add(handles, objectNames);
+	pendingNames.clear();
+
+	app->renderer3D->staticBatcher.MarkDirty();
+}
+
+void ObjectReservation::Add(uint32_t components, int count)
+{
+	const int mix = ((components & COMPONENT_BIT(ComponentType::MESH)) ? 1 : 0)
+		| ((components & COMPONENT_BIT(ComponentType::MATERIAL)) ? 2 : 0);
+	counts[mix] += count;
+}
+
+void ModuleScene::ReserveObjects(const ObjectReservation& reservation)
+{
+	const int* counts = reservation.counts;
+	const int total = counts[0] + counts[1] + counts[2] + counts[3];
+
+	gameObjects.Reserve(total);
+	transformComponents.Reserve(total);
+	meshComponents.Reserve(counts[1] + counts[3]);
+	materialComponents.Reserve(counts[2] + counts[3]);
+	transforms.Reserve(total);
+
+	for (int mix = 0; mix < 4; ++mix)
+	{
+		const uint32_t mask = COMPONENT_BIT(ComponentType::TRANSFORM)
+			| ((mix & 1) ? COMPONENT_BIT(ComponentType::MESH) : 0)
+			| ((mix & 2) ? COMPONENT_BIT(ComponentType::MATERIAL) : 0);
+		entities.Reserve(mask, counts[mix]);
+	}
+}
+
+GameObject* ModuleScene::GetGameObject(GameObjectHandle handle) const
+{
+	return gameObjects.Get(handle);
+}
+
+GameObjectHandle ModuleScene::GetHandle(const GameObject* gameObject) const
+{
+	return gameObjects.GetHandle(gameObject);
+}
+
+bool ModuleScene::SaveScene(const std::string& filePath)
+{
+	std::filesystem::path directory = std::filesystem::path(filePath).parent_path();
+	if (!directory.empty())
+		std::filesystem::create_directories(directory);
+
+	return SceneSerializer::Save(root, filePath);
+}
+
+bool ModuleScene::LoadScene(const std::string& filePath)
+{
+	GameObject* loaded = SceneSerializer::Load(filePath, nullptr);
+	if (loaded == nullptr)
+		return false;
+
+	DestroyGameObject(root);
+	root = loaded;
+
+	return true;
+}
+
+void ModuleScene::TakeSnapshot()
+{
+	Timer timer;
+
+	// The buffer keeps its capacity between plays, only the first one allocates
+	SceneSerializer::Write(root, snapshot);
+
+	LOG(LogType::LOG_INFO, "Scene snapshot: %d objects, %.1f KB in %.3f ms",
+		gameObjects.GetLiveCount(), snapshot.size() / 1024.0, timer.ReadMs());
+}
+
+bool ModuleScene::RestoreSnapshot()
+{
+	if (snapshot.empty())
+		return false;
+
+	Timer timer;
+
+	GameObject* restored = SceneSerializer::Read(snapshot.data(), snapshot.size(), nullptr);
+	if (restored == nullptr)
+	{
+		LOG(LogType::LOG_ERROR, "Scene snapshot could not be restored");
+		return false;
+	}
+	double readMs = timer.ReadMs();
+
+	DestroyGameObject(root);
+	root = restored;
+	double totalMs = timer.ReadMs();
+
+	LOG(LogType::LOG_INFO, "Scene restored: %d objects, %.1f KB in %.3f ms (%.3f ms rebuilding, %.3f ms releasing the played scene)",
+		gameObjects.GetLiveCount(), snapshot.size() / 1024.0, totalMs, readMs, totalMs - readMs);
+
+	snapshot.clear();
+
+	return true;
+}
+
+GameObject* ModuleScene::CreateInstancingBenchmark(int count)
+{
+	const std::string cubePath = "Engine/Primitives/Cube.fbx";
+
+	Resource* resource = app->resources->FindResourceInLibrary(cubePath, ResourceType::MODEL);
+	if (!resource)
+		resource = app->importer->ImportFileToLibrary(cubePath, ResourceType::MODEL);
+
+	GameObject* benchmarkRoot = CreateGameObject("Instancing Benchmark", root);
+
+	if (!resource || !app->importer->modelImporter->LoadModel(resource, benchmarkRoot))
+	{
+		LOG(LogType::LOG_ERROR, "Instancing benchmark: could not load %s", cubePath.c_str());
+		return benchmarkRoot;
+	}
+
+	GameObject* source = FindMeshObject(benchmarkRoot);
+	if (!source)
+	{
+		LOG(LogType::LOG_ERROR, "Instancing benchmark: cube model has no mesh");
+		return benchmarkRoot;
+	}
+
+	// Every copy shares the same Mesh* so the renderer can merge them into one draw
+	const int side = (int)std::ceil(std::cbrt((float)count));
+	const float spacing = 3.0f;
+	const float offset = (side - 1) * spacing * 0.5f;
+
+	for (int i = 1; i < count; ++i)
+	{
+		glm::vec3 position(
+			(i % side) * spacing - offset,
+			((i / side) % side) * spacing,
+			(i / (side * side)) * spacing - offset
+		);
+
+		GameObject* cube = CreateGameObject("Cube", benchmarkRoot);
+		cube->AddComponent(ComponentType::MESH);
+		cube->mesh->SetMesh(source->mesh->GetMesh());
+		if (source->material != nullptr)
+		{
+			cube->AddComponent(ComponentType::MATERIAL);
+			cube->material->SetTexture(source->material->GetTexture());
+		}
+		cube->transform->SetTransformMatrix(position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+	}
+
+	LOG(LogType::LOG_INFO, "Instancing benchmark created with %d cubes", count);
+
+	return benchmarkRoot;
+}
+
+GameObject* ModuleScene::CreateStressScene(const StressSceneSettings& settings)
+{
+	return generator.Generate(settings, root);
+}
+
+void ModuleScene::RunEntityBenchmark(int count)
+{
+	const int frames = 20;
+
+	StressSceneSettings settings;
+	settings.objects = count;
+	settings.meshRatio = 1.0f;
+	settings.staticRatio = 0.0f;
+
+	GameObject* generated = CreateStressScene(settings);
+
+	// World matrices for the new nodes, and the render thread kept off the workers while measuring
+	transforms.Update(*app->jobs);
+	app->renderer3D->renderThread.WaitIdle();
+
+	Frustum frustum;
+	frustum.Update(app->camera->GetProjectionMatrix() * app->camera->GetViewMatrix());
+
+	std::vector<DrawPacket> treePackets;
+	std::vector<DrawPacket> extractedPackets;
+
+	// Sorted too, the extractor hands its packets over in draw order
+	Timer timer;
+	for (int frame = 0; frame < frames; ++frame)
+	{
+		treePackets.clear();
+		GatherFromTree(root, transforms, frustum, treePackets);
+		std::sort(treePackets.begin(), treePackets.end(), DrawPacketLess);
+	}
+	double treeMs = timer.ReadMs() / frames;
+
+	SceneExtractor extractor;
+	double extractionMs[2] = {};
+
+	// One batch first, so the extractor runs on a single thread like the tree walk, then on all of them
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		extractor.batchCount = pass == 0 ? 1 : 0;
+		extractor.Extract(entities, transforms, &frustum, *app->jobs, extractedPackets);
+
+		timer.Start();
+		for (int frame = 0; frame < frames; ++frame)
+			extractor.Extract(entities, transforms, &frustum, *app->jobs, extractedPackets);
+		extractionMs[pass] = timer.ReadMs() / frames;
+	}
+
+	LOG(LogType::LOG_INFO, "Entity benchmark, %d mesh objects: object tree %.3f ms, extraction %.3f ms on one thread (%.2fx), %.3f ms on %d threads (%.2fx), %d/%d packets",
+		count, treeMs, extractionMs[0], extractionMs[0] > 0.0 ? treeMs / extractionMs[0] : 0.0,
+		extractionMs[1], app->jobs->GetThreadCount(), extractionMs[1] > 0.0 ? treeMs / extractionMs[1] : 0.0,
+		(int)treePackets.size(), (int)extractedPackets.size());
+
+	DestroyGameObject(generated);
+}
+
+void ModuleScene::RunSceneLoadBenchmark(int count)
+{
+	StressSceneSettings settings;
+	settings.objects = count;
+
+	GameObject* generated = CreateStressScene(settings);
+
+	std::vector<char> buffer;
+	SceneSerializer::Write(generated, buffer);
+
+	// Kept out of the scene, like a load that has not replaced the root yet. The generated scene stays
+	// until the end so its meshes are reused and only the objects are timed. The first read also grows
+	// the pools and archetypes, the second one reuses what the first left behind
+	double readMs[2] = {};
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		Timer timer;
+		GameObject* loaded = SceneSerializer::Read(buffer.data(), buffer.size(), nullptr);
+		readMs[pass] = timer.ReadMs();
+
+		DestroyGameObject(loaded);
+	}
+
+	DestroyGameObject(generated);
+
+	LOG(LogType::LOG_INFO, "Scene load benchmark, %d objects, %.1f KB: read in %.2f ms (%.2f ms into reused pools)",
+		count + 1, buffer.size() / 1024.0, readMs[0], readMs[1]);
+}
+
+void ModuleScene::RunAllocationBenchmark(int count)
+{
+	// Kept out of the scene, nothing else ever sees these objects
+	GameObject* benchmarkRoot = CreateGameObject("Allocation Benchmark", nullptr);
+
+	// The first pass also allocates the chunks, the second one only reuses freed slots
+	double pooledCreateMs[2] = {};
+	double pooledDestroyMs[2] = {};
+
+	Timer timer;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		timer.Start();
+		for (int i = 0; i < count; ++i)
+			CreateGameObject("GameObject", benchmarkRoot);
+		pooledCreateMs[pass] = timer.ReadMs();
+
+		timer.Start();
+		while (!benchmarkRoot->children.empty())
+			DestroyGameObject(benchmarkRoot->children.back());
+		pooledDestroyMs[pass] = timer.ReadMs();
+	}
+
+	DestroyGameObject(benchmarkRoot);
+
+	// The same through the old heap layout, freed in a shuffled order as edits over time would
+	LegacyGameObject* heapRoot = new LegacyGameObject("Allocation Benchmark", nullptr);
+	heapRoot->children.reserve(count);
+
+	timer.Start();
+	for (int i = 0; i < count; ++i)
+		heapRoot->children.push_back(new LegacyGameObject("GameObject", heapRoot));
+	const double heapCreateMs = timer.ReadMs();
+
+	std::shuffle(heapRoot->children.begin(), heapRoot->children.end(), std::mt19937(1));
+
+	timer.Start();
+	for (LegacyGameObject* child : heapRoot->children)
+		delete child;
+	const double heapDestroyMs = timer.ReadMs();
+
+	delete heapRoot;
+
+	const size_t pooledBytes = ObjectPool<GameObject>::SlotSize() + ObjectPool<ComponentTransform>::SlotSize();
+	// The components vector's single pointer is a fifth block
+	const size_t heapBytes = sizeof(LegacyGameObject) + sizeof(LegacyTransform) + sizeof(LegacyMesh) + sizeof(LegacyMaterial) + sizeof(LegacyComponent*);
+
+	LOG(LogType::LOG_INFO, "Allocation benchmark, %d empty GameObjects: create %.2f ms (%.2f ms reusing slots), destroy %.2f ms (%.2f ms), %zu bytes per object in 2 slots",
+		count, pooledCreateMs[0], pooledCreateMs[1], pooledDestroyMs[0], pooledDestroyMs[1], pooledBytes);
+	LOG(LogType::LOG_INFO, "Old heap layout: create %.2f ms, destroy %.2f ms, %zu bytes per object in 5 blocks before allocator overhead",
+		heapCreateMs, heapDestroyMs, heapBytes);
+	LOG(LogType::LOG_INFO, "Pools: %d/%d GameObjects, %.2f MB reserved",
+		gameObjects.GetLiveCount(), gameObjects.GetCapacity(),
+		(gameObjects.GetMemoryBytes() + transformComponents.GetMemoryBytes() + meshComponents.GetMemoryBytes() + materialComponents.GetMemoryBytes()) / (1024.0 * 1024.0));
+}
+
+GameObject* ModuleScene::FindMeshObject(GameObject* node) const
+{
+	if (node->GetComponent(ComponentType::MESH))
+		return node;
+
+	for (GameObject* child : node->children)
+	{
+		if (GameObject* found = FindMeshObject(child))
+			return found;
+	}
+
+	return nullptr;
 }
\ No newline at end of file
@@ -2,9 +2,24 @@
 
 #include "Module.h"
 #include "GameObject.h"
+#include "TransformHierarchy.h"
+#include "EntityRegistry.h"
+#include "ObjectPool.h"
+#include "NameIndex.h"
+#include "SceneGenerator.h"
+#include "ScaleBenchmark.h"
 
 class GameObject;
 
+// How many objects a loader is about to create, by which of mesh and material they carry besides the transform
+struct ObjectReservation
+{
+	void Add(uint32_t components, int count = 1);
+
+	// Indexed by 1 for a mesh plus 2 for a material
+	int counts[4] = {};
+};
+
 class ModuleScene : public Module
 {
 public:
@@ -16,7 +31,76 @@ public:
 	bool CleanUp();
 
 	GameObject* CreateGameObject(const char* name, GameObject* parent);
+	// components holds the COMPONENT_BIT of every component to add besides the transform, the entity
+	// goes straight into its final archetype
+	GameObject* CreateGameObject(const char* name, GameObject* parent, uint32_t components);
+
+	// For loaders building many objects at once: the names of everything created in between are
+	// indexed together when it ends instead of one by one
+	void BeginBulkCreate();
+	// Also has the static batches rebuilt once, for any static nodes that came in
+	void EndBulkCreate();
+	// Room for everything up front in the pools, the transform hierarchy and the archetypes, so building
+	// the objects never grows any of them
+	void ReserveObjects(const ObjectReservation& reservation);
+	// Children first, then unlinks it from its parent
+	void DestroyGameObject(GameObject* gameObject);
+
+	// Null once the object has been destroyed
+	GameObject* GetGameObject(GameObjectHandle handle) const;
+	GameObjectHandle GetHandle(const GameObject* gameObject) const;
+	// Changes whenever an object is created or destroyed anywhere in the scene
+	uint32_t GetHierarchyVersion() const { return hierarchyVersion; }
+
+	// Binary .scene files, see SceneSerializer. Loading replaces the current scene
+	bool SaveScene(const std::string& filePath);
+	bool LoadScene(const std::string& filePath);
+
+	// In-memory copy of the scene taken on Play and brought back on Stop, in the same format as a
+	// .scene file. Meshes and textures are shared with the live scene, not copied
+	void TakeSnapshot();
+	bool RestoreSnapshot();
+	bool HasSnapshot() const { return !snapshot.empty(); }
+
+	GameObject* CreateInstancingBenchmark(int count);
+	// Procedural scene under the root for testing at scale, see SceneGenerator
+	GameObject* CreateStressScene(const StressSceneSettings& settings);
+	// Logs the cost of creating and destroying count empty GameObjects, first into fresh chunks, then into reused
+	// slots, next to the same through the old one-heap-block-per-object layout
+	void RunAllocationBenchmark(int count);
+	// Logs what recording the draw list costs over a generated scene of count meshes, walking the
+	// GameObject tree against the SceneExtractor over the registry
+	void RunEntityBenchmark(int count);
+	// Logs how long reading back a generated scene of count objects takes, from an in-memory .scene buffer
+	void RunSceneLoadBenchmark(int count);
+
+private:
+	GameObject* FindMeshObject(GameObject* node) const;
 
 public:
 	GameObject* root = nullptr;
+
+	// Every ComponentTransform is a node in here
+	TransformHierarchy transforms;
+	// Component data of every GameObject
+	EntityRegistry entities;
+	// Names of every pooled GameObject, for searching
+	NameIndex names;
+
+	// Components are only allocated when added, declared before the objects so they outlive them
+	ObjectPool<ComponentTransform> transformComponents;
+	ObjectPool<ComponentMesh> meshComponents;
+	ObjectPool<ComponentMaterial> materialComponents;
+	ObjectPool<GameObject> gameObjects;
+
+	SceneGenerator generator;
+	// Ticked from Update while it runs
+	ScaleBenchmark scaleBenchmark;
+
+private:
+	std::vector<char> snapshot;
+
+	bool bulkCreating = false;
+	std::vector<GameObjectHandle> pendingNames;
+	uint32_t hierarchyVersion = 0;
 };
\ No newline at end of file
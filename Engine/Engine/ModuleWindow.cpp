@@ -14,7 +14,19 @@ bool ModuleWindow::Awake()
 	LOG(LogType::LOG_INFO, "Init SDL window & surface");
 	bool ret = true;
 
-	if (SDL_Init(SDL_INIT_VIDEO) < 0)
+	// The offscreen driver renders through EGL without a display, when SDL lacks it a hidden window is used
+	if (app->IsHeadless())
+	{
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 0);
+
+		if (SDL_Init(SDL_INIT_VIDEO) < 0)
+		{
+			LOG(LogType::LOG_WARNING, "Offscreen video driver not available (%s), using a hidden window", SDL_GetError());
+			SDL_setenv("SDL_VIDEODRIVER", "", 1);
+		}
+	}
+
+	if (SDL_WasInit(SDL_INIT_VIDEO) == 0 && SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
 		LOG(LogType::LOG_ERROR, "SDL_VIDEO could not initialize! SDL_Error: %s\n", SDL_GetError());
 		ret = false;
@@ -23,7 +35,7 @@ bool ModuleWindow::Awake()
 	{
 		width = SCREEN_WIDTH;
 		height = SCREEN_HEIGHT;
-		Uint32 flags = SDL_WINDOW_OPENGL | SDL_WINDOW_SHOWN;
+		Uint32 flags = SDL_WINDOW_OPENGL | (app->IsHeadless() ? SDL_WINDOW_HIDDEN : SDL_WINDOW_SHOWN);
 
 		if (fullscreen)
 			flags |= SDL_WINDOW_FULLSCREEN;
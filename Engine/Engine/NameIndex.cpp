@@ -0,0 +1,274 @@
+#include "NameIndex.h"
+#include "Logger.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cctype>
+
+#define MIN_STALE_REBUILD 4096
+
+void NameIndex::Add(PoolHandle handle, const std::string& name)
+{
+	if (!handle.IsValid())
+		return;
+
+	if (handle.index >= entries.size())
+		entries.resize(handle.index + 1);
+
+	Entry& entry = entries[handle.index];
+	if (entry.alive)
+		Remove({ handle.index, entry.generation });
+
+	ToLower(name.c_str(), entry.name);
+	entry.generation = handle.generation;
+	entry.alive = true;
+
+	AddPostings(handle.index);
+
+	++count;
+	++version;
+}
+
+void NameIndex::Add(const std::vector<PoolHandle>& handles, const std::vector<const std::string*>& names)
+{
+	uint32_t end = (uint32_t)entries.size();
+	for (PoolHandle handle : handles)
+	{
+		if (handle.IsValid() && handle.index >= end)
+			end = handle.index + 1;
+	}
+	entries.resize(end);
+
+	// Before any new name is in, a rebuild started by these would list the batch twice
+	for (PoolHandle handle : handles)
+	{
+		if (handle.IsValid() && entries[handle.index].alive)
+			Remove({ handle.index, entries[handle.index].generation });
+	}
+
+	// Only the names go in, their postings are added by the next Find. A load then doesn't pay for an
+	// index nobody may search
+	for (size_t i = 0; i < handles.size(); ++i)
+	{
+		const PoolHandle handle = handles[i];
+		if (!handle.IsValid())
+			continue;
+
+		Entry& entry = entries[handle.index];
+		ToLower(names[i]->c_str(), entry.name);
+		entry.generation = handle.generation;
+		entry.trigramCount = 0;
+		entry.alive = true;
+		entry.indexed = false;
+		++count;
+
+		unindexed.push_back(handle);
+	}
+
+	++version;
+}
+
+void NameIndex::Remove(PoolHandle handle)
+{
+	if (handle.index >= entries.size())
+		return;
+
+	Entry& entry = entries[handle.index];
+	if (!entry.alive || entry.generation != handle.generation)
+		return;
+
+	entry.alive = false;
+	entry.name.clear();
+	if (entry.indexed)
+		stalePostings += entry.trigramCount;
+	entry.indexed = false;
+
+	--count;
+	++version;
+
+	if (stalePostings > MIN_STALE_REBUILD && stalePostings * 2 > postingCount)
+		Rebuild();
+}
+
+void NameIndex::Rename(PoolHandle handle, const std::string& name)
+{
+	Remove(handle);
+	Add(handle, name);
+}
+
+void NameIndex::Clear()
+{
+	entries.clear();
+	postings.clear();
+	unindexed.clear();
+	postingCount = 0;
+	stalePostings = 0;
+	count = 0;
+	++version;
+}
+
+void NameIndex::Find(const char* query, std::vector<PoolHandle>& results)
+{
+	results.clear();
+
+	ToLower(query, lowerQuery);
+	if (lowerQuery.empty())
+		return;
+
+	IndexPending();
+
+	++queryStamp;
+
+	if (lowerQuery.size() < 3)
+	{
+		for (uint32_t i = 0; i < (uint32_t)entries.size(); ++i)
+		{
+			const Entry& entry = entries[i];
+			if (entry.alive && entry.name.find(lowerQuery) != std::string::npos)
+				results.push_back({ i, entry.generation });
+		}
+		return;
+	}
+
+	// Every match is listed under every trigram of the query, so the shortest list has them all
+	GetTrigrams(lowerQuery, trigrams);
+
+	const std::vector<uint32_t>* candidates = nullptr;
+	for (uint32_t trigram : trigrams)
+	{
+		auto found = postings.find(trigram);
+		if (found == postings.end())
+			return;
+
+		if (candidates == nullptr || found->second.size() < candidates->size())
+			candidates = &found->second;
+	}
+
+	// Stale postings and names holding the trigrams in another order are filtered here
+	for (uint32_t index : *candidates)
+	{
+		Entry& entry = entries[index];
+		if (!entry.alive || entry.queryStamp == queryStamp)
+			continue;
+
+		if (entry.name.find(lowerQuery) != std::string::npos)
+		{
+			entry.queryStamp = queryStamp;
+			results.push_back({ index, entry.generation });
+		}
+	}
+}
+
+void NameIndex::AddPostings(uint32_t index)
+{
+	Entry& entry = entries[index];
+
+	GetTrigrams(entry.name, trigrams);
+	entry.trigramCount = (uint32_t)trigrams.size();
+	entry.indexed = true;
+
+	for (uint32_t trigram : trigrams)
+		postings[trigram].push_back(index);
+
+	postingCount += trigrams.size();
+}
+
+void NameIndex::IndexPending()
+{
+	// Skips whatever was removed, renamed or already picked up by a rebuild since it was added
+	for (PoolHandle handle : unindexed)
+	{
+		const Entry& entry = entries[handle.index];
+		if (entry.alive && !entry.indexed && entry.generation == handle.generation)
+			AddPostings(handle.index);
+	}
+
+	unindexed.clear();
+}
+
+void NameIndex::Rebuild()
+{
+	// Keeps the lists themselves, most trigrams come back
+	for (auto& posting : postings)
+		posting.second.clear();
+
+	postingCount = 0;
+	stalePostings = 0;
+
+	for (uint32_t i = 0; i < (uint32_t)entries.size(); ++i)
+	{
+		if (entries[i].alive)
+			AddPostings(i);
+	}
+
+	unindexed.clear();
+}
+
+void NameIndex::ToLower(const char* text, std::string& lower)
+{
+	lower.assign(text);
+	for (char& c : lower)
+		c = (char)std::tolower((unsigned char)c);
+}
+
+void NameIndex::GetTrigrams(const std::string& text, std::vector<uint32_t>& trigrams)
+{
+	trigrams.clear();
+
+	for (size_t i = 0; i + 3 <= text.size(); ++i)
+	{
+		trigrams.push_back(((uint32_t)(unsigned char)text[i] << 16)
+			| ((uint32_t)(unsigned char)text[i + 1] << 8)
+			| (uint32_t)(unsigned char)text[i + 2]);
+	}
+
+	// Each object is listed once per distinct trigram
+	std::sort(trigrams.begin(), trigrams.end());
+	trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+}
+
+void NameIndex::RunBenchmark(int count)
+{
+	const char* words[] = { "Cube", "Sphere", "Wall", "Door", "Window", "Lamp", "Tree", "Rock", "Chair", "Table" };
+	const char* queries[] = { "lamp_12", "door", "e_7", "sphere_4999", "missing" };
+	const int wordCount = sizeof(words) / sizeof(words[0]);
+
+	std::vector<std::string> names(count);
+	for (int i = 0; i < count; ++i)
+		names[i] = std::string(words[i % wordCount]) + "_" + std::to_string(i);
+
+	NameIndex index;
+
+	Timer timer;
+	for (int i = 0; i < count; ++i)
+		index.Add({ (uint32_t)i, 0 }, names[i]);
+	double buildMs = timer.ReadMs();
+
+	LOG(LogType::LOG_INFO, "Name index benchmark, %d names: built in %.2f ms", count, buildMs);
+
+	std::vector<PoolHandle> results;
+	std::string lowerName;
+	std::string lowerQuery;
+
+	for (const char* query : queries)
+	{
+		timer.Start();
+		index.Find(query, results);
+		double indexMs = timer.ReadMs();
+
+		// What filtering the tree cost before: lowercasing and searching every name
+		timer.Start();
+		int scanMatches = 0;
+		ToLower(query, lowerQuery);
+		for (const std::string& name : names)
+		{
+			ToLower(name.c_str(), lowerName);
+			if (lowerName.find(lowerQuery) != std::string::npos)
+				++scanMatches;
+		}
+		double scanMs = timer.ReadMs();
+
+		LOG(LogType::LOG_INFO, "\"%s\": index %.3f ms, scan %.3f ms (%.1fx), %d/%d matches",
+			query, indexMs, scanMs, indexMs > 0.0 ? scanMs / indexMs : 0.0, (int)results.size(), scanMatches);
+	}
+}
\ No newline at end of file
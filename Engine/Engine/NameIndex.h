@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ObjectPool.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Case-insensitive substring search over object names without walking the scene. Every name is split
+// into its trigrams, a query only checks the objects listed under its rarest trigram. Removing an object
+// leaves its postings behind until enough of them are stale to be worth rebuilding
+class NameIndex
+{
+public:
+	void Add(PoolHandle handle, const std::string& name);
+	// Many new objects at once. Only the names are stored, they are indexed by the next Find
+	void Add(const std::vector<PoolHandle>& handles, const std::vector<const std::string*>& names);
+	void Remove(PoolHandle handle);
+	void Rename(PoolHandle handle, const std::string& name);
+	void Clear();
+
+	// Every object whose name contains query, in no particular order. Queries shorter than a trigram
+	// scan the names instead, they match most of the scene anyway
+	void Find(const char* query, std::vector<PoolHandle>& results);
+
+	// Changes on every add, remove and rename, for callers that cache results
+	uint32_t GetVersion() const { return version; }
+	int GetCount() const { return count; }
+
+	// Logs index build and query times against comparing every name, as the hierarchy used to
+	static void RunBenchmark(int count);
+
+private:
+	struct Entry
+	{
+		// Lowercase
+		std::string name;
+		uint32_t generation = 0;
+		uint32_t trigramCount = 0;
+		// Last query that returned it, so an object listed twice is only returned once
+		uint32_t queryStamp = 0;
+		bool alive = false;
+		// Its postings are in, false while it waits in unindexed
+		bool indexed = false;
+	};
+
+	void AddPostings(uint32_t index);
+	void IndexPending();
+	void Rebuild();
+
+	static void ToLower(const char* text, std::string& lower);
+	static void GetTrigrams(const std::string& text, std::vector<uint32_t>& trigrams);
+
+private:
+	// Indexed like the pool the handles come from
+	std::vector<Entry> entries;
+	std::unordered_map<uint32_t, std::vector<uint32_t>> postings;
+	// Added in a batch, not in the postings yet
+	std::vector<PoolHandle> unindexed;
+
+	size_t postingCount = 0;
+	size_t stalePostings = 0;
+
+	std::vector<uint32_t> trigrams;
+	std::string lowerQuery;
+	uint32_t queryStamp = 0;
+
+	uint32_t version = 0;
+	int count = 0;
+};
\ No newline at end of file
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#define INVALID_POOL_INDEX 0xFFFFFFFFu
+
+// Refers to a pooled object without keeping it alive. The generation changes every time a slot is
+// reused, so a handle to a destroyed object resolves to null instead of to whatever took its place
+struct PoolHandle
+{
+	uint32_t index = INVALID_POOL_INDEX;
+	uint32_t generation = 0;
+
+	bool IsValid() const { return index != INVALID_POOL_INDEX; }
+	bool operator==(const PoolHandle& other) const { return index == other.index && generation == other.generation; }
+	bool operator!=(const PoolHandle& other) const { return !(*this == other); }
+};
+
+// Objects of one type in fixed-size chunks. Slots never move, so pointers stay valid until the object
+// is destroyed, and freed slots are reused before a new chunk is allocated
+template <typename T, size_t ChunkSize = 256>
+class ObjectPool
+{
+public:
+	ObjectPool() {}
+	~ObjectPool() { Clear(); }
+
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	template <typename... Args>
+	T* Create(Args&&... args)
+	{
+		if (freeHead == INVALID_POOL_INDEX)
+			AddChunk();
+
+		Slot& slot = GetSlot(freeHead);
+		freeHead = slot.nextFree;
+
+		T* object = new (slot.storage) T(std::forward<Args>(args)...);
+		slot.alive = true;
+		++liveCount;
+
+		return object;
+	}
+
+	void Destroy(T* object)
+	{
+		if (object == nullptr)
+			return;
+
+		Slot& slot = *reinterpret_cast<Slot*>(object);
+		object->~T();
+
+		slot.alive = false;
+		++slot.generation;
+		slot.nextFree = freeHead;
+		freeHead = slot.index;
+		--liveCount;
+	}
+
+	// Adds chunks until count more objects fit without allocating
+	void Reserve(int count)
+	{
+		while ((int)capacity - liveCount < count)
+			AddChunk();
+	}
+
+	PoolHandle GetHandle(const T* object) const
+	{
+		PoolHandle handle;
+		if (object != nullptr)
+		{
+			const Slot& slot = *reinterpret_cast<const Slot*>(object);
+			handle.index = slot.index;
+			handle.generation = slot.generation;
+		}
+		return handle;
+	}
+
+	// Null for invalid handles and for objects destroyed since the handle was taken
+	T* Get(PoolHandle handle) const
+	{
+		if (handle.index >= capacity)
+			return nullptr;
+
+		Slot& slot = GetSlot(handle.index);
+		if (!slot.alive || slot.generation != handle.generation)
+			return nullptr;
+
+		return reinterpret_cast<T*>(slot.storage);
+	}
+
+	// Destroys whatever is still alive and releases the chunks
+	void Clear()
+	{
+		for (uint32_t i = 0; i < capacity; ++i)
+		{
+			Slot& slot = GetSlot(i);
+			if (slot.alive)
+				reinterpret_cast<T*>(slot.storage)->~T();
+		}
+
+		chunks.clear();
+		capacity = 0;
+		liveCount = 0;
+		freeHead = INVALID_POOL_INDEX;
+	}
+
+	int GetLiveCount() const { return liveCount; }
+	int GetCapacity() const { return (int)capacity; }
+	size_t GetMemoryBytes() const { return chunks.size() * ChunkSize * sizeof(Slot); }
+
+	static constexpr size_t SlotSize() { return sizeof(Slot); }
+
+private:
+	// The object comes first so a T* is also a Slot*
+	struct Slot
+	{
+		alignas(T) unsigned char storage[sizeof(T)];
+		uint32_t index = 0;
+		uint32_t generation = 0;
+		uint32_t nextFree = INVALID_POOL_INDEX;
+		bool alive = false;
+	};
+
+	Slot& GetSlot(uint32_t index) const
+	{
+		return chunks[index / ChunkSize][index % ChunkSize];
+	}
+
+	void AddChunk()
+	{
+		chunks.emplace_back(new Slot[ChunkSize]);
+
+		// Linked in order so the new chunk fills front to back
+		Slot* chunk = chunks.back().get();
+		for (size_t i = ChunkSize; i-- > 0;)
+		{
+			chunk[i].index = capacity + (uint32_t)i;
+			chunk[i].nextFree = freeHead;
+			freeHead = chunk[i].index;
+		}
+
+		capacity += (uint32_t)ChunkSize;
+	}
+
+private:
+	std::vector<std::unique_ptr<Slot[]>> chunks;
+	uint32_t capacity = 0;
+	uint32_t freeHead = INVALID_POOL_INDEX;
+	int liveCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,371 @@
+#include "OcclusionCuller.h"
+#include "GameObject.h"
+#include "ModuleJobs.h"
+#include "Logger.h"
+
+#include <emmintrin.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#define OCCLUSION_TILES_X (OCCLUSION_BUFFER_WIDTH / OCCLUSION_TILE_SIZE)
+#define OCCLUSION_TILES_Y (OCCLUSION_BUFFER_HEIGHT / OCCLUSION_TILE_SIZE)
+#define OCCLUSION_NEAR_W 0.0001f
+
+OcclusionCuller::OcclusionCuller()
+{
+	depthBuffer.assign(OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT, 1.0f);
+	tileMaxDepth.assign(OCCLUSION_TILES_X * OCCLUSION_TILES_Y, 1.0f);
+}
+
+OcclusionCuller::~OcclusionCuller()
+{
+}
+
+void OcclusionCuller::CollectOccluders(GameObject* root)
+{
+	candidates.clear();
+	CollectNode(root);
+
+	candidateCount = (int)candidates.size();
+	dirty = false;
+
+	LOG(LogType::LOG_INFO, "Occlusion culling found %d occluder candidates", candidateCount);
+}
+
+void OcclusionCuller::CollectNode(GameObject* node)
+{
+	if (!node->isActive)
+		return;
+
+	if (node->isStatic && node->GetComponent(ComponentType::MESH) && node->mesh->GetMesh() != nullptr)
+	{
+		const Mesh* mesh = node->mesh->GetMesh();
+
+		if (mesh->IsValid() && (int)(mesh->indicesCount / 3) <= maxOccluderTriangles)
+		{
+			const glm::mat4& world = node->transform->GetGlobalTransform();
+
+			glm::vec3 center = glm::vec3(world * glm::vec4((mesh->aabbMin + mesh->aabbMax) * 0.5f, 1.0f));
+			glm::vec3 localExtents = (mesh->aabbMax - mesh->aabbMin) * 0.5f;
+
+			glm::vec3 extents(0.0f);
+			for (int i = 0; i < 3; ++i)
+				extents += glm::abs(glm::vec3(world[i])) * localExtents[i];
+
+			if (std::max(extents.x, std::max(extents.y, extents.z)) * 2.0f >= minOccluderSize)
+			{
+				Occluder occluder;
+				occluder.mesh = mesh;
+				occluder.transform = world;
+				occluder.center = center;
+				occluder.radius = glm::length(extents);
+				candidates.push_back(occluder);
+			}
+		}
+	}
+
+	for (GameObject* child : node->children)
+		CollectNode(child);
+}
+
+void OcclusionCuller::Render(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, ModuleJobs& jobs)
+{
+	this->viewProjection = viewProjection;
+
+	// Keep the candidates that would cover the most screen, skipping those behind the camera
+	selected.clear();
+	for (const Occluder& occluder : candidates)
+	{
+		glm::vec4 clip = viewProjection * glm::vec4(occluder.center, 1.0f);
+		if (clip.w + occluder.radius > 0.0f)
+			selected.push_back(&occluder);
+	}
+
+	auto coverage = [&cameraPosition](const Occluder* occluder)
+		{
+			float distance = std::max(glm::length(occluder->center - cameraPosition) - occluder->radius, 0.01f);
+			return occluder->radius / distance;
+		};
+
+	if ((int)selected.size() > maxOccluders)
+	{
+		std::partial_sort(selected.begin(), selected.begin() + maxOccluders, selected.end(),
+			[&coverage](const Occluder* a, const Occluder* b) { return coverage(a) > coverage(b); });
+		selected.resize(maxOccluders);
+	}
+
+	occluderTriangles.resize(selected.size());
+
+	jobs.ParallelFor((int)selected.size(), [this](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				SetupTriangles(*selected[i], occluderTriangles[i]);
+		});
+
+	// Each worker owns a horizontal band of the buffer, so no pixel is shared between threads
+	jobs.ParallelFor(OCCLUSION_BUFFER_HEIGHT / OCCLUSION_BAND_HEIGHT, [this](int begin, int end)
+		{
+			for (int band = begin; band < end; ++band)
+				RasterizeBand(band * OCCLUSION_BAND_HEIGHT, (band + 1) * OCCLUSION_BAND_HEIGHT);
+		});
+
+	renderedOccluders = (int)selected.size();
+	rasterizedTriangles = 0;
+	for (size_t i = 0; i < selected.size(); ++i)
+		rasterizedTriangles += (int)occluderTriangles[i].size();
+
+	rendered = true;
+}
+
+void OcclusionCuller::SetupTriangles(const Occluder& occluder, std::vector<OccluderTriangle>& triangles) const
+{
+	triangles.clear();
+
+	const Mesh* mesh = occluder.mesh;
+	glm::mat4 modelViewProjection = viewProjection * occluder.transform;
+
+	thread_local std::vector<glm::vec4> clip;
+	clip.resize(mesh->verticesCount);
+
+	for (uint i = 0; i < mesh->verticesCount; ++i)
+		clip[i] = modelViewProjection * glm::vec4(mesh->vertices[i * 3], mesh->vertices[i * 3 + 1], mesh->vertices[i * 3 + 2], 1.0f);
+
+	for (uint i = 0; i + 2 < mesh->indicesCount; i += 3)
+	{
+		OccluderTriangle triangle;
+		bool valid = true;
+
+		for (int k = 0; k < 3 && valid; ++k)
+		{
+			const glm::vec4& vertex = clip[mesh->indices[i + k]];
+
+			// Dropping triangles that cross the near plane only makes the buffer less occluding
+			if (vertex.w <= OCCLUSION_NEAR_W)
+			{
+				valid = false;
+				break;
+			}
+
+			float invW = 1.0f / vertex.w;
+			triangle.v[k] = glm::vec3(
+				(vertex.x * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH,
+				(vertex.y * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT,
+				vertex.z * invW * 0.5f + 0.5f
+			);
+		}
+
+		if (!valid)
+			continue;
+
+		float minX = std::min(triangle.v[0].x, std::min(triangle.v[1].x, triangle.v[2].x));
+		float maxX = std::max(triangle.v[0].x, std::max(triangle.v[1].x, triangle.v[2].x));
+		float minY = std::min(triangle.v[0].y, std::min(triangle.v[1].y, triangle.v[2].y));
+		float maxY = std::max(triangle.v[0].y, std::max(triangle.v[1].y, triangle.v[2].y));
+
+		if (maxX < 0.0f || maxY < 0.0f || minX >= OCCLUSION_BUFFER_WIDTH || minY >= OCCLUSION_BUFFER_HEIGHT)
+			continue;
+
+		triangles.push_back(triangle);
+	}
+}
+
+void OcclusionCuller::RasterizeBand(int minY, int maxY)
+{
+	for (int y = minY; y < maxY; ++y)
+		std::fill(Row(y), Row(y) + OCCLUSION_BUFFER_WIDTH, 1.0f);
+
+	for (size_t i = 0; i < selected.size(); ++i)
+	{
+		for (const OccluderTriangle& triangle : occluderTriangles[i])
+			RasterizeTriangle(triangle, minY, maxY);
+	}
+
+	UpdateTileDepth(minY, maxY);
+}
+
+void OcclusionCuller::RasterizeTriangle(const OccluderTriangle& triangle, int minY, int maxY)
+{
+	glm::vec3 a = triangle.v[0];
+	glm::vec3 b = triangle.v[1];
+	glm::vec3 c = triangle.v[2];
+
+	float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+	if (std::fabs(area) < 1e-6f)
+		return;
+
+	// Occluders are rasterized double sided, flip to a consistent winding
+	if (area < 0.0f)
+	{
+		std::swap(b, c);
+		area = -area;
+	}
+
+	int x0 = std::max(0, (int)std::floor(std::min(a.x, std::min(b.x, c.x))));
+	int x1 = std::min(OCCLUSION_BUFFER_WIDTH - 1, (int)std::ceil(std::max(a.x, std::max(b.x, c.x))));
+	int y0 = std::max(minY, (int)std::floor(std::min(a.y, std::min(b.y, c.y))));
+	int y1 = std::min(maxY - 1, (int)std::ceil(std::max(a.y, std::max(b.y, c.y))));
+
+	if (x0 > x1 || y0 > y1)
+		return;
+
+	// Edge functions E(x, y) = A * x + B * y + C, positive inside
+	float A0 = b.y - c.y, B0 = c.x - b.x, C0 = b.x * c.y - b.y * c.x;
+	float A1 = c.y - a.y, B1 = a.x - c.x, C1 = c.x * a.y - c.y * a.x;
+	float A2 = a.y - b.y, B2 = b.x - a.x, C2 = a.x * b.y - a.y * b.x;
+
+	// Depth plane from barycentrics, E1 weights b and E2 weights c
+	float invArea = 1.0f / area;
+	float dzdx = ((b.z - a.z) * A1 + (c.z - a.z) * A2) * invArea;
+	float dzdy = ((b.z - a.z) * B1 + (c.z - a.z) * B2) * invArea;
+	float z0 = a.z + ((b.z - a.z) * C1 + (c.z - a.z) * C2) * invArea;
+
+	const __m128 offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+	const __m128 zero = _mm_setzero_ps();
+
+	__m128 edgeA0 = _mm_set1_ps(A0), edgeA1 = _mm_set1_ps(A1), edgeA2 = _mm_set1_ps(A2);
+	__m128 depthDx = _mm_set1_ps(dzdx);
+
+	int xStart = x0 & ~3;
+
+	for (int y = y0; y <= y1; ++y)
+	{
+		float py = (float)y + 0.5f;
+		__m128 row0 = _mm_set1_ps(B0 * py + C0);
+		__m128 row1 = _mm_set1_ps(B1 * py + C1);
+		__m128 row2 = _mm_set1_ps(B2 * py + C2);
+		__m128 rowDepth = _mm_set1_ps(dzdy * py + z0);
+
+		float* row = Row(y);
+
+		for (int x = xStart; x <= x1; x += 4)
+		{
+			__m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+
+			__m128 e0 = _mm_add_ps(_mm_mul_ps(edgeA0, px), row0);
+			__m128 e1 = _mm_add_ps(_mm_mul_ps(edgeA1, px), row1);
+			__m128 e2 = _mm_add_ps(_mm_mul_ps(edgeA2, px), row2);
+
+			__m128 inside = _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_and_ps(_mm_cmpge_ps(e1, zero), _mm_cmpge_ps(e2, zero)));
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 depth = _mm_add_ps(_mm_mul_ps(depthDx, px), rowDepth);
+			__m128 previous = _mm_loadu_ps(row + x);
+			__m128 nearest = _mm_min_ps(previous, depth);
+
+			_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, previous)));
+		}
+	}
+}
+
+void OcclusionCuller::UpdateTileDepth(int minY, int maxY)
+{
+	for (int tileY = minY / OCCLUSION_TILE_SIZE; tileY < maxY / OCCLUSION_TILE_SIZE; ++tileY)
+	{
+		for (int tileX = 0; tileX < OCCLUSION_TILES_X; ++tileX)
+		{
+			__m128 farthest = _mm_setzero_ps();
+
+			for (int y = tileY * OCCLUSION_TILE_SIZE; y < (tileY + 1) * OCCLUSION_TILE_SIZE; ++y)
+			{
+				const float* row = Row(y) + tileX * OCCLUSION_TILE_SIZE;
+				for (int x = 0; x < OCCLUSION_TILE_SIZE; x += 4)
+					farthest = _mm_max_ps(farthest, _mm_loadu_ps(row + x));
+			}
+
+			farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(2, 3, 0, 1)));
+			farthest = _mm_max_ps(farthest, _mm_shuffle_ps(farthest, farthest, _MM_SHUFFLE(1, 0, 3, 2)));
+
+			tileMaxDepth[tileY * OCCLUSION_TILES_X + tileX] = _mm_cvtss_f32(farthest);
+		}
+	}
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& min, const glm::vec3& max) const
+{
+	return IsVisible(min, max, glm::mat4(1.0f));
+}
+
+bool OcclusionCuller::IsVisible(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform) const
+{
+	if (!rendered || renderedOccluders == 0)
+		return true;
+
+	glm::mat4 modelViewProjection = viewProjection * transform;
+
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	float nearestDepth = FLT_MAX;
+
+	for (int i = 0; i < 8; ++i)
+	{
+		glm::vec3 corner((i & 1) ? max.x : min.x, (i & 2) ? max.y : min.y, (i & 4) ? max.z : min.z);
+		glm::vec4 clip = modelViewProjection * glm::vec4(corner, 1.0f);
+
+		// Boxes touching the near plane are always treated as visible
+		if (clip.w <= OCCLUSION_NEAR_W)
+			return true;
+
+		float invW = 1.0f / clip.w;
+		float x = (clip.x * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_WIDTH;
+		float y = (clip.y * invW * 0.5f + 0.5f) * OCCLUSION_BUFFER_HEIGHT;
+
+		minX = std::min(minX, x);
+		maxX = std::max(maxX, x);
+		minY = std::min(minY, y);
+		maxY = std::max(maxY, y);
+		nearestDepth = std::min(nearestDepth, clip.z * invW * 0.5f + 0.5f);
+	}
+
+	int x0 = std::max(0, (int)std::floor(minX));
+	int x1 = std::min(OCCLUSION_BUFFER_WIDTH - 1, (int)std::floor(maxX));
+	int y0 = std::max(0, (int)std::floor(minY));
+	int y1 = std::min(OCCLUSION_BUFFER_HEIGHT - 1, (int)std::floor(maxY));
+
+	// Off screen boxes are left to the frustum test
+	if (x0 > x1 || y0 > y1)
+		return true;
+
+	return IsRectVisible(x0, y0, x1, y1, nearestDepth);
+}
+
+bool OcclusionCuller::IsRectVisible(int minX, int minY, int maxX, int maxY, float depth) const
+{
+	const __m128 objectDepth = _mm_set1_ps(depth);
+	const __m128 lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+
+	for (int tileY = minY / OCCLUSION_TILE_SIZE; tileY <= maxY / OCCLUSION_TILE_SIZE; ++tileY)
+	{
+		for (int tileX = minX / OCCLUSION_TILE_SIZE; tileX <= maxX / OCCLUSION_TILE_SIZE; ++tileX)
+		{
+			// The whole tile is in front of the box
+			if (depth > tileMaxDepth[tileY * OCCLUSION_TILES_X + tileX])
+				continue;
+
+			int x0 = std::max(minX, tileX * OCCLUSION_TILE_SIZE);
+			int x1 = std::min(maxX, (tileX + 1) * OCCLUSION_TILE_SIZE - 1);
+			int y0 = std::max(minY, tileY * OCCLUSION_TILE_SIZE);
+			int y1 = std::min(maxY, (tileY + 1) * OCCLUSION_TILE_SIZE - 1);
+
+			__m128 first = _mm_set1_ps((float)x0);
+			__m128 last = _mm_set1_ps((float)x1);
+
+			for (int y = y0; y <= y1; ++y)
+			{
+				const float* row = Row(y);
+
+				for (int x = x0 & ~3; x <= x1; x += 4)
+				{
+					__m128 px = _mm_add_ps(_mm_set1_ps((float)x), lanes);
+					__m128 inside = _mm_and_ps(_mm_cmpge_ps(px, first), _mm_cmple_ps(px, last));
+					__m128 visible = _mm_and_ps(inside, _mm_cmpge_ps(_mm_loadu_ps(row + x), objectDepth));
+
+					if (_mm_movemask_ps(visible) != 0)
+						return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#define OCCLUSION_BUFFER_WIDTH 256
+#define OCCLUSION_BUFFER_HEIGHT 128
+#define OCCLUSION_TILE_SIZE 8
+#define OCCLUSION_BAND_HEIGHT 16
+
+class GameObject;
+class Mesh;
+class ModuleJobs;
+
+struct Occluder
+{
+	const Mesh* mesh = nullptr;
+	glm::mat4 transform = glm::mat4(1.0f);
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+};
+
+// Screen space triangle ready for the rasterizer, depth in [0, 1]
+struct OccluderTriangle
+{
+	glm::vec3 v[3];
+};
+
+// Rasterizes a few large static meshes into a small CPU depth buffer and tests bounds against it
+class OcclusionCuller
+{
+public:
+	OcclusionCuller();
+	~OcclusionCuller();
+
+	void CollectOccluders(GameObject* root);
+	void Render(const glm::mat4& viewProjection, const glm::vec3& cameraPosition, ModuleJobs& jobs);
+
+	bool IsVisible(const glm::vec3& min, const glm::vec3& max) const;
+	bool IsVisible(const glm::vec3& min, const glm::vec3& max, const glm::mat4& transform) const;
+
+	void MarkDirty() { dirty = true; }
+	bool IsDirty() const { return dirty; }
+
+public:
+	int maxOccluders = 16;
+	int maxOccluderTriangles = 4096;
+	float minOccluderSize = 4.0f;
+
+	int candidateCount = 0;
+	int renderedOccluders = 0;
+	int rasterizedTriangles = 0;
+
+private:
+	void CollectNode(GameObject* node);
+	void SetupTriangles(const Occluder& occluder, std::vector<OccluderTriangle>& triangles) const;
+	void RasterizeBand(int minY, int maxY);
+	void RasterizeTriangle(const OccluderTriangle& triangle, int minY, int maxY);
+	void UpdateTileDepth(int minY, int maxY);
+	bool IsRectVisible(int minX, int minY, int maxX, int maxY, float depth) const;
+	float* Row(int y) { return depthBuffer.data() + y * OCCLUSION_BUFFER_WIDTH; }
+	const float* Row(int y) const { return depthBuffer.data() + y * OCCLUSION_BUFFER_WIDTH; }
+
+private:
+	std::vector<Occluder> candidates;
+	std::vector<const Occluder*> selected;
+	std::vector<std::vector<OccluderTriangle>> occluderTriangles;
+
+	// Row major, processed four pixels at a time. Each tile keeps its farthest depth so
+	// most tests are answered without touching pixels
+	std::vector<float> depthBuffer;
+	std::vector<float> tileMaxDepth;
+
+	glm::mat4 viewProjection = glm::mat4(1.0f);
+	bool rendered = false;
+	bool dirty = true;
+};
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "PerformanceWindow.h"
 #include "App.h"
+#include "TransformKernels.h"
 
 #include <psapi.h>
 
@@ -45,11 +46,9 @@ void PerformanceWindow::DrawWindow()
 		static float values[100];
 		static int values_offset = 0;
 
-		GLint memoryTotal = 0;
-		glGetIntegerv(GL_GPU_MEMORY_INFO_TOTAL_AVAILABLE_MEMORY_NVX, &memoryTotal);
-
-		GLint memoryAvailable = 0;
-		glGetIntegerv(GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &memoryAvailable);
+		// Queried by whichever thread owns the context at the end of its frame
+		GLint memoryTotal = app->renderer3D->renderStats.gpuMemoryTotalKb;
+		GLint memoryAvailable = app->renderer3D->renderStats.gpuMemoryAvailableKb;
 
 		GLint memoryUse = memoryTotal - memoryAvailable;
 		GLfloat memoryUsePercentage = (static_cast<GLfloat>(memoryUse) / static_cast<GLfloat>(memoryTotal)) * 100;
@@ -95,6 +94,8 @@ void PerformanceWindow::DrawWindow()
 			ImVec2(ImGui::GetColumnWidth() - 20, 80.0f)
 		);
 
+		DrawGpuStageTimings();
+
 		ImGui::TreePop();
 	}
 
@@ -231,11 +232,45 @@ void PerformanceWindow::DrawWindow()
 			ImVec2(ImGui::GetColumnWidth() - 20, 80.0f)
 		);
 
+		const FramePacingStats& pacing = app->pacer.GetStats();
+
+		ImGui::SeparatorText("Frame Pacing");
+
+		ImGui::Text("Frame Time:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.2f ms avg, %.2f ms target", pacing.avgMs, pacing.targetMs);
+
+		ImGui::Text("Jitter:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms std dev, %.3f ms worst", pacing.jitterMs, pacing.maxDeviationMs);
+
+		ImGui::Text("Limiter:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms overshoot, %d missed deadlines", pacing.overshootMs, pacing.missedDeadlines);
+
+		char pacingOverlay[32];
+		sprintf_s(pacingOverlay, "%.3f ms jitter", pacing.jitterMs);
+		ImGui::PlotLines(
+			"##FramePacing",
+			app->pacer.GetHistory(),
+			FRAME_PACER_HISTORY,
+			app->pacer.GetHistoryOffset(),
+			pacingOverlay,
+			0.0f,
+			pacing.targetMs * 2.0f,
+			ImVec2(ImGui::GetColumnWidth() - 20, 80.0f)
+		);
+
 		ImGui::Checkbox("FPS Overlay", &showFpsOverlay);
-		if (ImGui::Checkbox("VSync", &app->vsync))
-			SDL_GL_SetSwapInterval(app->vsync ? 1 : 0);
 
-		ImGui::BeginDisabled(app->vsync);
+		static const char* vsyncOptions[] = { "Off", "On", "Adaptive" };
+		int vsyncIndex = (int)app->vsync;
+
+		ImGui::SetNextItemWidth(100);
+		if (ImGui::Combo("VSync", &vsyncIndex, vsyncOptions, IM_ARRAYSIZE(vsyncOptions)))
+			app->SetVSync((VSyncMode)vsyncIndex);
+
+		ImGui::BeginDisabled(app->vsync != VSyncMode::OFF);
 
 		static int selectedFpsIndex = 1;
 
@@ -246,10 +281,350 @@ void PerformanceWindow::DrawWindow()
 			app->maxFps = std::stoi(fpsOptions[selectedFpsIndex]);
 		}
 
+		ImGui::SetNextItemWidth(100);
+		ImGui::SliderFloat("Spin Margin", &app->pacer.spinMs, 0.0f, 4.0f, "%.1f ms");
+
 		ImGui::EndDisabled();
 
 		ImGui::TreePop();
 	}
 
+	if (ImGui::TreeNodeEx("RENDERER", ImGuiTreeNodeFlags_DefaultOpen))
+	{
+		const RenderStats& stats = app->renderer3D->renderStats;
+
+		float frameMs = app->GetDT() * 1000.0f;
+		frameTimeHistory[frameTimeHistoryOffset] = frameMs;
+		frameTimeHistoryOffset = (frameTimeHistoryOffset + 1) % FPS_HISTORY_SIZE;
+
+		ImGui::SeparatorText("Information");
+
+		ImGui::Text("Objects:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d", stats.objects);
+
+		int frustumCulled = stats.culledObjects + stats.culledStaticObjects;
+		int occluded = stats.occludedObjects + stats.occludedStaticObjects;
+		float objectCount = (float)(stats.objects > 0 ? stats.objects : 1);
+
+		ImGui::Text("Frustum Culled:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d (%.1f%%)", frustumCulled, frustumCulled * 100.0f / objectCount);
+
+		ImGui::Text("Occlusion Culled:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d (%.1f%%)", occluded, occluded * 100.0f / objectCount);
+
+		ImGui::Text("Occluders:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d of %d candidates (%d triangles)", stats.occluders,
+			app->renderer3D->occlusionCuller.candidateCount, stats.occluderTriangles);
+
+		const TransformHierarchy& transforms = app->scene->transforms;
+
+		ImGui::Text("Transforms:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d nodes, %d updated in %.3f ms (%s)", transforms.GetCount(), transforms.updatedNodes,
+			transforms.updatedNodes > 0 ? transforms.updateMs : 0.0f, TransformKernels::GetLevelName(TransformKernels::GetLevel()));
+
+		ImGui::Text("Entities:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d in %d archetypes, %d/%d pooled objects", app->scene->entities.GetCount(), app->scene->entities.GetArchetypeCount(),
+			app->scene->gameObjects.GetLiveCount(), app->scene->gameObjects.GetCapacity());
+
+		ImGui::Text("Jobs:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d threads, %d jobs, %d stolen", app->jobs->GetThreadCount(), app->jobs->frameJobs,
+			app->jobs->frameSteals);
+
+		ImGui::Text("Draw List Extraction:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms", stats.extractionMs);
+
+		ImGui::Text("Culling Cost:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms (%.3f ms rasterizing, %d threads)", stats.cullingMs, stats.occlusionRasterMs,
+			app->jobs->GetThreadCount());
+
+		ImGui::Text("Render Submit:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms on %s thread (main waited %.3f ms)", stats.submitMs,
+			stats.renderThread ? "render" : "main", stats.mainWaitMs);
+
+		ImGui::Text("Streamed:");
+		ImGui::SameLine();
+		if (app->renderer3D->streamBuffer.IsAvailable())
+			ImGui::TextColored(dataTextColor, "%.1f KB of %d KB (%d fence stalls, %.3f ms, %d overflows)", stats.streamedBytes / 1024.0f,
+				(int)(app->renderer3D->streamBuffer.GetFrameSize() / 1024), stats.fenceStalls, stats.fenceStallMs, stats.streamOverflows);
+		else
+			ImGui::TextColored(dataTextColor, "Persistent mapping not supported");
+
+		ImGui::Text("Draw Calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d", stats.drawCalls);
+
+		ImGui::Text("Instanced Draw Calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d (%d instances)", stats.instancedDrawCalls, stats.instances);
+
+		ImGui::Text("Multi-Draw Indirect Calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d (%d commands)", stats.indirectDrawCalls, stats.indirectCommands);
+
+		ImGui::Text("Static Batch Draw Calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d (%d objects, %d culled)", stats.staticDrawCalls, stats.staticObjects, stats.culledStaticObjects);
+
+		const GLStateCache& glState = app->renderer3D->glState;
+		int glStateCalls = glState.lastFrameIssued + glState.lastFrameSkipped;
+
+		ImGui::Text("GL State Calls:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d issued, %d skipped (%.1f%%)", glState.lastFrameIssued, glState.lastFrameSkipped,
+			glState.lastFrameSkipped * 100.0f / (float)(glStateCalls > 0 ? glStateCalls : 1));
+
+		const GeometryArena& arena = app->renderer3D->geometryArena;
+
+		ImGui::Text("Geometry Arena:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%d meshes, %u / %u vertices, %u / %u indices", arena.allocations,
+			arena.vertexAllocator.used, arena.vertexAllocator.capacity, arena.indexAllocator.used, arena.indexAllocator.capacity);
+
+		ImGui::Text("Render Target:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%dx%d (%.0f%% of %dx%d)", app->renderer3D->fboWidth, app->renderer3D->fboHeight,
+			app->renderer3D->renderScale * 100.0f, app->renderer3D->sceneWidth, app->renderer3D->sceneHeight);
+
+		const ShaderCache& shaderCache = app->renderer3D->shaderCache;
+
+		ImGui::Text("Shader Cache:");
+		ImGui::SameLine();
+		if (shaderCache.IsAvailable())
+			ImGui::TextColored(dataTextColor, "%d hits, %d misses (%.2f ms loading shaders)", shaderCache.hits, shaderCache.misses, app->renderer3D->shaderLoadMs);
+		else
+			ImGui::TextColored(dataTextColor, "unsupported (%.2f ms loading shaders)", app->renderer3D->shaderLoadMs);
+
+		ImGui::Text("Scene Submission:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms", stats.sceneMs);
+
+		ImGui::Text("Frame Time:");
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "%.3f ms", frameMs);
+
+		char frameTimeOverlay[32];
+		sprintf_s(frameTimeOverlay, "%.2f ms", frameMs);
+		ImGui::PlotLines(
+			"##FrameTimeHistory",
+			frameTimeHistory,
+			FPS_HISTORY_SIZE,
+			frameTimeHistoryOffset,
+			frameTimeOverlay,
+			0.0f,
+			FLT_MAX,
+			ImVec2(ImGui::GetColumnWidth() - 20, 80.0f)
+		);
+
+		ImGui::Checkbox("Frustum Culling", &app->renderer3D->useFrustumCulling);
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Occlusion Culling", &app->renderer3D->useOcclusionCulling);
+
+		ImGui::SameLine();
+		ImGui::Checkbox("GL State Cache", &app->renderer3D->useGLStateCache);
+
+		ImGui::SameLine();
+		ImGui::Checkbox("Render Thread", &app->renderer3D->useRenderThread);
+
+		ImGui::BeginDisabled(IsInstancingBenchmarkRunning());
+
+		ImGui::Checkbox("GPU Instancing", &app->renderer3D->useInstancing);
+
+		ImGui::SameLine();
+		ImGui::BeginDisabled(!app->renderer3D->indirectSupported || !app->renderer3D->useInstancing);
+		ImGui::Checkbox("Multi-Draw Indirect", &app->renderer3D->useIndirectDraw);
+		ImGui::EndDisabled();
+
+		ImGui::SetNextItemWidth(100);
+		ImGui::SliderInt("Instancing Threshold", &app->renderer3D->instancingThreshold, 2, 64);
+
+		if (ImGui::Button("Compare Instancing"))
+			StartInstancingBenchmark();
+
+		ImGui::SameLine();
+		if (ImGui::Button("Extraction Scaling"))
+			app->renderer3D->RunExtractionBenchmark();
+
+		ImGui::EndDisabled();
+
+		// Only the levels this CPU runs are offered
+		static const char* simdOptions[] = { "Scalar", "SSE", "AVX2" };
+		int simdIndex = (int)TransformKernels::GetLevel();
+
+		ImGui::SetNextItemWidth(100);
+		if (ImGui::Combo("Transform SIMD", &simdIndex, simdOptions, (int)TransformKernels::GetSupportedLevel() + 1))
+			TransformKernels::SetLevel((SimdLevel)simdIndex);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Transform Kernels"))
+			TransformKernels::RunBenchmark(100000);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Job System"))
+			app->jobs->RunBenchmark();
+
+		ImGui::SameLine();
+		if (ImGui::Button("Entities"))
+			app->scene->RunEntityBenchmark(100000);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Allocation"))
+			app->scene->RunAllocationBenchmark(100000);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Name Index"))
+			NameIndex::RunBenchmark(100000);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Scene Load"))
+			app->scene->RunSceneLoadBenchmark(100000);
+
+		ImGui::Checkbox("Dynamic Resolution", &app->renderer3D->dynamicResolution);
+
+		ImGui::BeginDisabled(!app->renderer3D->dynamicResolution);
+		ImGui::SetNextItemWidth(100);
+		ImGui::SliderFloat("Target Frame Time", &app->renderer3D->targetFrameMs, 4.0f, 50.0f, "%.1f ms");
+		ImGui::SameLine();
+		ImGui::SetNextItemWidth(100);
+		ImGui::SliderFloat("Min Scale", &app->renderer3D->minRenderScale, 0.25f, 1.0f, "%.2f");
+		ImGui::EndDisabled();
+
+		if (ImGui::Checkbox("Static Batching", &app->renderer3D->useStaticBatching) && app->renderer3D->useStaticBatching)
+			app->renderer3D->staticBatcher.MarkDirty();
+
+		ImGui::SameLine();
+		ImGui::BeginDisabled(!app->renderer3D->useStaticBatching);
+		if (ImGui::Button("Rebuild Static Batches"))
+			app->renderer3D->staticBatcher.MarkDirty();
+		ImGui::EndDisabled();
+
+		if (IsInstancingBenchmarkRunning())
+		{
+			ImGui::SameLine();
+			ImGui::Text("Running... %d%%", benchmarkFrame * 100 / ((BENCHMARK_WARMUP_FRAMES + BENCHMARK_FRAMES) * 2));
+		}
+
+		ImGui::TreePop();
+	}
+
 	ImGui::End();
+}
+
+void PerformanceWindow::DrawGpuStageTimings()
+{
+	ImVec4 dataTextColor = app->editor->dataTextColor;
+	GpuProfiler& profiler = app->renderer3D->gpuProfiler;
+
+	ImGui::SeparatorText("Stage Timings");
+
+	if (!profiler.IsAvailable())
+	{
+		ImGui::TextColored(dataTextColor, "Timer queries not supported");
+		return;
+	}
+
+	ImGui::Checkbox("GPU Timers", &app->renderer3D->useGpuTimers);
+
+	// Work submitted on the CPU against time spent on the GPU tells which side limits the frame
+	float cpuMs = app->renderer3D->frameWorkMs;
+	float gpuMs = profiler.frameMs;
+
+	ImGui::Text("CPU / GPU:");
+	ImGui::SameLine();
+	ImGui::TextColored(dataTextColor, "%.2f ms / %.2f ms (%s-bound, %d frames dropped)", cpuMs, gpuMs,
+		gpuMs > cpuMs ? "GPU" : "CPU", profiler.droppedFrames);
+
+	for (int i = 0; i < (int)GpuStage::COUNT; ++i)
+	{
+		GpuStage stage = (GpuStage)i;
+		const GpuStageTimings& timings = profiler.GetTimings(stage);
+
+		ImGui::Text("%s:", GpuProfiler::GetStageName(stage));
+		ImGui::SameLine();
+		ImGui::TextColored(dataTextColor, "min %.3f / avg %.3f / max %.3f ms", timings.minMs, timings.avgMs, timings.maxMs);
+
+		char overlay[32];
+		sprintf_s(overlay, "%.3f ms", timings.lastMs);
+
+		ImGui::PushID(i);
+		ImGui::PlotLines(
+			"##StageHistory",
+			timings.history,
+			GPU_PROFILER_HISTORY,
+			timings.historyOffset,
+			overlay,
+			0.0f,
+			timings.maxMs > 0.0f ? timings.maxMs * 1.2f : 1.0f,
+			ImVec2(ImGui::GetColumnWidth() - 20, 50.0f)
+		);
+		ImGui::PopID();
+	}
+}
+
+void PerformanceWindow::StartInstancingBenchmark()
+{
+	benchmarkPreviousInstancing = app->renderer3D->useInstancing;
+	benchmarkFrame = 0;
+
+	for (int i = 0; i < 2; ++i)
+	{
+		benchmarkFrameMs[i] = 0.0;
+		benchmarkSceneMs[i] = 0.0;
+		benchmarkDrawCalls[i] = 0;
+	}
+
+	app->renderer3D->useInstancing = false;
+
+	if (app->vsync != VSyncMode::OFF)
+		LOG(LogType::LOG_WARNING, "Instancing benchmark: VSync is on, frame times will be capped by the display");
+
+	LOG(LogType::LOG_INFO, "Instancing benchmark started");
+}
+
+void PerformanceWindow::UpdateInstancingBenchmark()
+{
+	if (benchmarkFrame < 0)
+		return;
+
+	const int phaseLength = BENCHMARK_WARMUP_FRAMES + BENCHMARK_FRAMES;
+	const int phase = benchmarkFrame / phaseLength;
+
+	if (benchmarkFrame % phaseLength >= BENCHMARK_WARMUP_FRAMES)
+	{
+		const RenderStats& stats = app->renderer3D->renderStats;
+
+		benchmarkFrameMs[phase] += app->GetDT() * 1000.0;
+		benchmarkSceneMs[phase] += stats.sceneMs;
+		benchmarkDrawCalls[phase] = stats.drawCalls;
+	}
+
+	++benchmarkFrame;
+
+	if (benchmarkFrame == phaseLength)
+	{
+		app->renderer3D->useInstancing = true;
+	}
+	else if (benchmarkFrame == phaseLength * 2)
+	{
+		const char* labels[2] = { "off", "on" };
+
+		for (int i = 0; i < 2; ++i)
+		{
+			LOG(LogType::LOG_INFO, "Instancing %s: %d draw calls, %.3f ms frame, %.3f ms scene submission",
+				labels[i], benchmarkDrawCalls[i], benchmarkFrameMs[i] / BENCHMARK_FRAMES, benchmarkSceneMs[i] / BENCHMARK_FRAMES);
+		}
+
+		app->renderer3D->useInstancing = benchmarkPreviousInstancing;
+		benchmarkFrame = -1;
+	}
 }
\ No newline at end of file
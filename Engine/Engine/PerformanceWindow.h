@@ -1,6 +1,9 @@
 #pragma once
 
 #include "EditorWindow.h"
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
 #include <windows.h>
 #include "GL/glew.h"
 
@@ -12,10 +15,16 @@ public:
 
 	void DrawWindow() override;
 
+	void StartInstancingBenchmark();
+	void UpdateInstancingBenchmark();
+	bool IsInstancingBenchmarkRunning() const { return benchmarkFrame >= 0; }
+
 public:
 	bool showFpsOverlay = false;
 
 private:
+	void DrawGpuStageTimings();
+
 	// CPU
 	std::string cpuName;
 	SYSTEM_INFO sysInfo;
@@ -39,4 +48,17 @@ private:
 	float fpsHistory[FPS_HISTORY_SIZE] = {};
 	int fpsHistoryOffset = 0;
 	const char* fpsOptions[6] = { "30", "60", "90", "120", "144", "240" };
+
+	// Renderer
+	float frameTimeHistory[FPS_HISTORY_SIZE] = {};
+	int frameTimeHistoryOffset = 0;
+
+	// Instancing benchmark: half the frames without instancing, half with it
+	static const int BENCHMARK_WARMUP_FRAMES = 30;
+	static const int BENCHMARK_FRAMES = 240;
+	int benchmarkFrame = -1;
+	bool benchmarkPreviousInstancing = true;
+	double benchmarkFrameMs[2] = {};
+	double benchmarkSceneMs[2] = {};
+	int benchmarkDrawCalls[2] = {};
 };
\ No newline at end of file
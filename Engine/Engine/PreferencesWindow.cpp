@@ -37,8 +37,8 @@ void PreferencesWindow::DrawWindow()
 	if (ImGui::CollapsingHeader("Render", ImGuiTreeNodeFlags_DefaultOpen))
 	{
 		ImGui::Checkbox("Show Textures", &drawTextures);
-		if (ImGui::Checkbox("Cull face", &cullFace))
-			cullFace ? glEnable(GL_CULL_FACE) : glDisable(GL_CULL_FACE);
+		// Captured into the render settings with the rest, GL is only touched by the scene pass
+		ImGui::Checkbox("Cull face", &cullFace);
 
 		ImGui::Spacing();
 		ImGui::Separator();
@@ -0,0 +1,191 @@
+#include "RenderThread.h"
+#include "Timer.h"
+#include "Logger.h"
+
+RenderThread::RenderThread()
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+bool RenderThread::Start(SDL_Window* window, SDL_GLContext context, const std::function<void(int frame)>& execute)
+{
+	if (running)
+		return true;
+
+	// A context can only be current on one thread, the render thread takes it on its first frame
+	if (SDL_GL_MakeCurrent(window, nullptr) != 0)
+	{
+		LOG(LogType::LOG_ERROR, "Render thread: could not release the GL context: %s", SDL_GetError());
+		return false;
+	}
+
+	this->window = window;
+	this->context = context;
+	this->execute = execute;
+
+	quit = false;
+	busy = false;
+	releaseRequested = false;
+	ownsContext = false;
+	pendingFrame = -1;
+	lockDepth = 0;
+
+	running = true;
+	thread = std::thread(&RenderThread::Run, this);
+
+	LOG(LogType::LOG_INFO, "Render thread started");
+	return true;
+}
+
+void RenderThread::Stop()
+{
+	if (!running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	wake.notify_all();
+
+	thread.join();
+	running = false;
+	renderThreadId = std::thread::id();
+
+	// The thread released the context on exit, hand it back to the caller
+	SDL_GL_MakeCurrent(window, context);
+
+	LOG(LogType::LOG_INFO, "Render thread stopped");
+}
+
+double RenderThread::WaitIdle()
+{
+	if (!running)
+		return 0.0;
+
+	Timer waitTimer;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return !busy && pendingFrame < 0; });
+
+	return waitTimer.ReadMs();
+}
+
+void RenderThread::Kick(int frame)
+{
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		idle.wait(lock, [this] { return !busy && pendingFrame < 0; });
+
+		if (lockDepth > 0)
+		{
+			LOG(LogType::LOG_ERROR, "Render thread: frame kicked while the context is borrowed");
+			return;
+		}
+
+		pendingFrame = frame;
+	}
+	wake.notify_all();
+}
+
+void RenderThread::AcquireContext()
+{
+	std::unique_lock<std::mutex> lock(mutex);
+
+	if (lockDepth++ > 0)
+		return;
+
+	idle.wait(lock, [this] { return !busy && pendingFrame < 0; });
+
+	releaseRequested = true;
+	wake.notify_all();
+	idle.wait(lock, [this] { return !releaseRequested; });
+
+	lock.unlock();
+	SDL_GL_MakeCurrent(window, context);
+}
+
+void RenderThread::ReleaseContext()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+
+	if (--lockDepth > 0)
+		return;
+
+	SDL_GL_MakeCurrent(window, nullptr);
+}
+
+void RenderThread::Run()
+{
+	renderThreadId = std::this_thread::get_id();
+
+	while (true)
+	{
+		int frame = -1;
+
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this] { return quit || releaseRequested || pendingFrame >= 0; });
+
+			if (releaseRequested)
+			{
+				if (ownsContext)
+				{
+					SDL_GL_MakeCurrent(window, nullptr);
+					ownsContext = false;
+				}
+
+				releaseRequested = false;
+				idle.notify_all();
+				continue;
+			}
+
+			if (quit)
+				break;
+
+			frame = pendingFrame;
+			pendingFrame = -1;
+			busy = true;
+		}
+
+		// Taken back lazily, borrowing the context between frames costs one switch each way
+		if (!ownsContext)
+		{
+			SDL_GL_MakeCurrent(window, context);
+			ownsContext = true;
+		}
+
+		execute(frame);
+
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			busy = false;
+		}
+		idle.notify_all();
+	}
+
+	if (ownsContext)
+	{
+		SDL_GL_MakeCurrent(window, nullptr);
+		ownsContext = false;
+	}
+}
+
+GLContextLock::GLContextLock(RenderThread& renderThread) : renderThread(renderThread)
+{
+	if (renderThread.IsRunning() && !renderThread.IsRenderThread())
+	{
+		renderThread.AcquireContext();
+		locked = true;
+	}
+}
+
+GLContextLock::~GLContextLock()
+{
+	if (locked)
+		renderThread.ReleaseContext();
+}
\ No newline at end of file
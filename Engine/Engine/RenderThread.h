@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SDL2/SDL.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+// Runs frame submission on its own thread, which owns the GL context while it is running.
+// The main thread hands over one frame at a time and only waits when the previous one is still in flight
+class RenderThread
+{
+public:
+	RenderThread();
+	~RenderThread();
+
+	// The calling thread gives up the context until Stop
+	bool Start(SDL_Window* window, SDL_GLContext context, const std::function<void(int frame)>& execute);
+	void Stop();
+
+	bool IsRunning() const { return running; }
+	bool IsRenderThread() const { return std::this_thread::get_id() == renderThreadId.load(); }
+
+	// Blocks until the frame in flight, if any, has been submitted. Returns the time spent waiting
+	double WaitIdle();
+	void Kick(int frame);
+
+	// Lets the main thread borrow the context for uploads, nesting is allowed
+	void AcquireContext();
+	void ReleaseContext();
+
+private:
+	void Run();
+
+private:
+	std::thread thread;
+	std::atomic<std::thread::id> renderThreadId;
+	std::mutex mutex;
+	std::condition_variable wake;
+	std::condition_variable idle;
+
+	std::function<void(int)> execute;
+	SDL_Window* window = nullptr;
+	SDL_GLContext context = nullptr;
+
+	bool running = false;
+	bool quit = false;
+	bool busy = false;
+	bool releaseRequested = false;
+	bool ownsContext = false;
+	int pendingFrame = -1;
+	int lockDepth = 0;
+};
+
+// Scoped AcquireContext for GL work outside the render thread, does nothing when the thread is off
+class GLContextLock
+{
+public:
+	explicit GLContextLock(RenderThread& renderThread);
+	~GLContextLock();
+
+private:
+	RenderThread& renderThread;
+	bool locked = false;
+};
\ No newline at end of file
@@ -0,0 +1,123 @@
+#include "ScaleBenchmark.h"
+#include "App.h"
+#include "Timer.h"
+
+#include <fstream>
+
+void ScaleBenchmark::Start(const StressSceneSettings& settings, int maxObjects, const std::string& timingsPath)
+{
+	if (IsRunning())
+		return;
+
+	this->settings = settings;
+	this->maxObjects = maxObjects < SCALE_BENCHMARK_MIN_OBJECTS ? SCALE_BENCHMARK_MIN_OBJECTS : maxObjects;
+	this->timingsPath = timingsPath;
+
+	if (app->vsync != VSyncMode::OFF && !app->IsHeadless())
+		LOG(LogType::LOG_WARNING, "Scale benchmark: VSync is on, frame times will be capped by the display");
+
+	LOG(LogType::LOG_INFO, "Scale benchmark started, %d to %d objects", SCALE_BENCHMARK_MIN_OBJECTS, this->maxObjects);
+
+	steps.clear();
+	objects = SCALE_BENCHMARK_MIN_OBJECTS;
+	BeginStep();
+}
+
+void ScaleBenchmark::Update()
+{
+	if (!IsRunning())
+		return;
+
+	if (frame >= SCALE_BENCHMARK_WARMUP_FRAMES)
+	{
+		// The renderer and editor numbers are from the last frame they finished, the warmup hides the lag
+		const RenderStats& stats = app->renderer3D->renderStats;
+
+		current.frameMs += app->GetDT() * 1000.0;
+		// A clean hierarchy returns early and leaves the last rebuild's time behind, it cost nothing this frame
+		const TransformHierarchy& transforms = app->scene->transforms;
+		current.transformMs += transforms.updatedNodes > 0 ? transforms.updateMs : 0.0f;
+		current.extractionMs += stats.extractionMs;
+		current.cullingMs += stats.cullingMs;
+		current.submissionMs += stats.sceneMs;
+		current.imguiMs += app->editor->buildMs;
+		// Both totals already take in the static batches
+		current.drawCalls = stats.drawCalls;
+		current.visibleObjects = stats.objects - stats.culledObjects - stats.occludedObjects
+			- stats.culledStaticObjects - stats.occludedStaticObjects;
+	}
+
+	++frame;
+
+	if (frame < SCALE_BENCHMARK_WARMUP_FRAMES + SCALE_BENCHMARK_FRAMES)
+		return;
+
+	EndStep();
+
+	// Ten times larger each step, the last one lands exactly on the maximum
+	if (objects >= maxObjects)
+	{
+		Finish();
+		return;
+	}
+
+	objects = objects > maxObjects / 10 ? maxObjects : objects * 10;
+	BeginStep();
+}
+
+void ScaleBenchmark::BeginStep()
+{
+	current = ScaleBenchmarkStep();
+	current.objects = objects;
+	frame = 0;
+
+	StressSceneSettings stepSettings = settings;
+	stepSettings.objects = objects;
+
+	Timer timer;
+	GameObject* generated = app->scene->CreateStressScene(stepSettings);
+	current.generateMs = (float)timer.ReadMs();
+
+	generatedRoot = app->scene->GetHandle(generated);
+}
+
+void ScaleBenchmark::EndStep()
+{
+	current.frameMs /= SCALE_BENCHMARK_FRAMES;
+	current.transformMs /= SCALE_BENCHMARK_FRAMES;
+	current.extractionMs /= SCALE_BENCHMARK_FRAMES;
+	current.cullingMs /= SCALE_BENCHMARK_FRAMES;
+	current.submissionMs /= SCALE_BENCHMARK_FRAMES;
+	current.imguiMs /= SCALE_BENCHMARK_FRAMES;
+
+	steps.push_back(current);
+
+	LOG(LogType::LOG_INFO, "Scale benchmark, %d objects: generated in %.1f ms, %.3f ms frame, %.3f ms transforms, %.3f ms extraction, %.3f ms culling, %.3f ms submission, %.3f ms ImGui, %d draw calls, %d visible",
+		current.objects, current.generateMs, current.frameMs, current.transformMs, current.extractionMs, current.cullingMs,
+		current.submissionMs, current.imguiMs, current.drawCalls, current.visibleObjects);
+
+	// Null if it was deleted from the editor while the step ran
+	app->scene->DestroyGameObject(app->scene->GetGameObject(generatedRoot));
+	generatedRoot = PoolHandle();
+}
+
+void ScaleBenchmark::Finish()
+{
+	objects = 0;
+
+	std::ofstream file(timingsPath, std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG(LogType::LOG_ERROR, "Scale benchmark: cannot write timings to %s", timingsPath.c_str());
+		return;
+	}
+
+	file << "objects,generate_ms,frame_ms,transform_ms,extraction_ms,culling_ms,submission_ms,imgui_ms,draw_calls,visible_objects\n";
+	for (const ScaleBenchmarkStep& step : steps)
+	{
+		file << step.objects << "," << step.generateMs << "," << step.frameMs << "," << step.transformMs << "," << step.extractionMs
+			<< "," << step.cullingMs << "," << step.submissionMs << "," << step.imguiMs << "," << step.drawCalls << "," << step.visibleObjects << "\n";
+	}
+
+	LOG(LogType::LOG_INFO, "Scale benchmark finished, %d sizes written to %s", (int)steps.size(), timingsPath.c_str());
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "SceneGenerator.h"
+#include "ObjectPool.h"
+
+#include <string>
+#include <vector>
+
+#define SCALE_BENCHMARK_MIN_OBJECTS 1000
+#define SCALE_BENCHMARK_MAX_OBJECTS 1000000
+// Covers the static batches and the render thread's frame of lag catching up with a new scene
+#define SCALE_BENCHMARK_WARMUP_FRAMES 10
+#define SCALE_BENCHMARK_FRAMES 60
+
+// Per-frame averages for one scene size
+struct ScaleBenchmarkStep
+{
+	int objects = 0;
+	float generateMs = 0.0f;
+	double frameMs = 0.0;
+	double transformMs = 0.0;
+	double extractionMs = 0.0;
+	double cullingMs = 0.0;
+	double submissionMs = 0.0;
+	double imguiMs = 0.0;
+	int drawCalls = 0;
+	int visibleObjects = 0;
+};
+
+// Generates stress scenes ten times larger each step, from 1k objects up to a maximum, and records
+// what every frame stage costs at each size. Runs over many frames so the renderer's numbers are real
+class ScaleBenchmark
+{
+public:
+	void Start(const StressSceneSettings& settings, int maxObjects, const std::string& timingsPath);
+	// Once per frame, after the transforms have updated
+	void Update();
+
+	bool IsRunning() const { return objects > 0; }
+	// Every size measured by the last run
+	const std::vector<ScaleBenchmarkStep>& GetSteps() const { return steps; }
+
+private:
+	void BeginStep();
+	void EndStep();
+	void Finish();
+
+private:
+	StressSceneSettings settings;
+	int maxObjects = SCALE_BENCHMARK_MAX_OBJECTS;
+	std::string timingsPath;
+
+	int objects = 0;
+	int frame = 0;
+	PoolHandle generatedRoot;
+	ScaleBenchmarkStep current;
+	std::vector<ScaleBenchmarkStep> steps;
+};
\ No newline at end of file
@@ -0,0 +1,165 @@
+#include "SceneExtractor.h"
+#include "Mesh.h"
+#include "ModuleJobs.h"
+#include "Timer.h"
+
+#include <algorithm>
+
+// Below this, handing a batch to another thread costs more than recording it
+#define SCENE_EXTRACTOR_MIN_BATCH 256
+#define SCENE_EXTRACTOR_BATCHES_PER_THREAD 4
+
+SceneExtractor::SceneExtractor()
+{
+}
+
+void SceneExtractor::Extract(EntityRegistry& entities, const TransformHierarchy& transforms, const Frustum* frustum, ModuleJobs& jobs, std::vector<DrawPacket>& packets)
+{
+	Timer extractionTimer;
+
+	packets.clear();
+	Gather(entities);
+
+	const int count = (int)renderables.size();
+
+	int batchSize;
+	if (batchCount > 0)
+	{
+		batchSize = (count + batchCount - 1) / batchCount;
+	}
+	else
+	{
+		int batches = jobs.GetThreadCount() * SCENE_EXTRACTOR_BATCHES_PER_THREAD;
+		batchSize = (count + batches - 1) / batches;
+		if (batchSize < SCENE_EXTRACTOR_MIN_BATCH)
+			batchSize = SCENE_EXTRACTOR_MIN_BATCH;
+	}
+	if (batchSize < 1)
+		batchSize = 1;
+
+	// One list per batch rather than per thread, whichever thread takes a batch owns its list
+	lists.resize((count + batchSize - 1) / batchSize);
+	for (DrawList& list : lists)
+	{
+		list.packets.clear();
+		list.objects = 0;
+		list.culledObjects = 0;
+	}
+
+	jobs.ParallelFor(count, [&](int begin, int end)
+		{
+			DrawList& list = lists[begin / batchSize];
+
+			for (int i = begin; i < end; ++i)
+			{
+				const Renderable& renderable = renderables[i];
+
+				DrawPacket packet;
+				packet.mesh = renderable.mesh->mesh;
+				packet.textureId = renderable.textureId;
+				packet.transform = transforms.GetWorld(renderable.transform);
+				packet.vertexNormals = renderable.mesh->showVertexNormals;
+				packet.faceNormals = renderable.mesh->showFaceNormals;
+				packet.normalsOnly = renderable.mesh->inStaticBatch;
+
+				if (!packet.normalsOnly)
+					list.objects++;
+
+				if (frustum != nullptr && !frustum->IntersectsAABB(packet.mesh->aabbMin, packet.mesh->aabbMax, packet.transform))
+				{
+					if (!packet.normalsOnly)
+						list.culledObjects++;
+					continue;
+				}
+
+				list.packets.push_back(packet);
+			}
+
+			std::sort(list.packets.begin(), list.packets.end(), DrawPacketLess);
+		}, batchSize);
+
+	Merge(jobs, packets);
+
+	extractionMs = (float)extractionTimer.ReadMs();
+}
+
+void SceneExtractor::Gather(EntityRegistry& entities)
+{
+	renderables.clear();
+
+	const uint32_t mask = COMPONENT_BIT(ComponentType::TRANSFORM) | COMPONENT_BIT(ComponentType::MESH);
+
+	entities.ForEach(mask, [this](Archetype& archetype)
+		{
+			const bool hasMaterial = archetype.Has(ComponentType::MATERIAL);
+
+			for (size_t row = 0; row < archetype.Size(); ++row)
+			{
+				// Disabled covers inactive ancestors too
+				const MeshData& mesh = archetype.meshes[row];
+				if (!archetype.enabled[row] || mesh.mesh == nullptr)
+					continue;
+
+				// Meshes merged into a static batch are drawn by the batcher, only their normals are still recorded
+				if (mesh.inStaticBatch && !mesh.showVertexNormals && !mesh.showFaceNormals)
+					continue;
+
+				Renderable renderable;
+				renderable.mesh = &mesh;
+				renderable.textureId = hasMaterial ? archetype.materials[row].textureId : (GLuint)-1;
+				renderable.transform = archetype.transforms[row].id;
+				renderables.push_back(renderable);
+			}
+		});
+}
+
+void SceneExtractor::Merge(ModuleJobs& jobs, std::vector<DrawPacket>& packets)
+{
+	objects = 0;
+	culledObjects = 0;
+
+	runs.clear();
+	runs.push_back(0);
+
+	for (const DrawList& list : lists)
+	{
+		objects += list.objects;
+		culledObjects += list.culledObjects;
+		runs.push_back(runs.back() + list.packets.size());
+	}
+
+	packets.resize(runs.back());
+
+	jobs.ParallelFor((int)lists.size(), [&](int begin, int end)
+		{
+			for (int i = begin; i < end; ++i)
+				std::copy(lists[i].packets.begin(), lists[i].packets.end(), packets.begin() + runs[i]);
+		});
+
+	// Each level merges neighbouring runs in pairs, in parallel, halving their number
+	while (runs.size() > 2)
+	{
+		int pairs = (int)(runs.size() - 1) / 2;
+
+		jobs.ParallelFor(pairs, [&](int begin, int end)
+			{
+				for (int i = begin; i < end; ++i)
+				{
+					std::inplace_merge(packets.begin() + runs[i * 2], packets.begin() + runs[i * 2 + 1],
+						packets.begin() + runs[i * 2 + 2], DrawPacketLess);
+				}
+			});
+
+		size_t last = runs.back();
+		size_t kept = 0;
+
+		for (size_t i = 0; i < runs.size(); i += 2)
+			runs[kept++] = runs[i];
+
+		// An odd run out is carried to the next level as is
+		if (runs[kept - 1] != last)
+			runs[kept++] = last;
+
+		runs.resize(kept);
+	}
+}
\ No newline at end of file
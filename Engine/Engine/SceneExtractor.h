@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Frustum.h"
+#include "EntityRegistry.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class Mesh;
+class ModuleJobs;
+
+struct DrawPacket
+{
+	Mesh* mesh = nullptr;
+	GLuint textureId = 0;
+	glm::mat4 transform = glm::mat4(1.0f);
+	bool vertexNormals = false;
+	bool faceNormals = false;
+	bool normalsOnly = false;
+};
+
+// Packets sharing texture and mesh end up adjacent, normals-only packets go last
+inline bool DrawPacketLess(const DrawPacket& a, const DrawPacket& b)
+{
+	if (a.normalsOnly != b.normalsOnly)
+		return b.normalsOnly;
+	if (a.textureId != b.textureId)
+		return a.textureId < b.textureId;
+	return a.mesh < b.mesh;
+}
+
+// Builds the frame's draw list on the job system. The mesh arrays of the registry are flattened once, then each batch
+// culls its objects and records into its own list. The lists are sorted where they were recorded and
+// merged pairwise, so the result comes out ordered for instancing without a global sort
+class SceneExtractor
+{
+public:
+	SceneExtractor();
+
+	// frustum can be null to skip culling
+	void Extract(EntityRegistry& entities, const TransformHierarchy& transforms, const Frustum* frustum, ModuleJobs& jobs, std::vector<DrawPacket>& packets);
+
+public:
+	// 0 gives every thread a few batches to balance the load, otherwise caps the threads taking part
+	int batchCount = 0;
+
+	// Last Extract
+	int objects = 0;
+	int culledObjects = 0;
+	float extractionMs = 0.0f;
+
+private:
+	void Gather(EntityRegistry& entities);
+	void Merge(ModuleJobs& jobs, std::vector<DrawPacket>& packets);
+
+private:
+	struct DrawList
+	{
+		std::vector<DrawPacket> packets;
+		int objects = 0;
+		int culledObjects = 0;
+	};
+
+	struct Renderable
+	{
+		const MeshData* mesh = nullptr;
+		GLuint textureId = 0;
+		TransformId transform = INVALID_TRANSFORM;
+	};
+
+	std::vector<Renderable> renderables;
+	std::vector<DrawList> lists;
+	std::vector<size_t> runs;
+};
\ No newline at end of file
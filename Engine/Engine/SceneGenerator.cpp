@@ -0,0 +1,265 @@
+#include "SceneGenerator.h"
+#include "App.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+
+namespace
+{
+	const char* PRIMITIVE_PATHS[STRESS_PRIMITIVE_COUNT] =
+	{
+		"Engine/Primitives/Cube.fbx",
+		"Engine/Primitives/Sphere.fbx",
+		"Engine/Primitives/Cylinder.fbx",
+		"Engine/Primitives/Capsule.fbx"
+	};
+
+	Mesh* FindMesh(const GameObject* node)
+	{
+		if (node->mesh != nullptr && node->mesh->GetMesh() != nullptr)
+			return node->mesh->GetMesh();
+
+		for (const GameObject* child : node->children)
+		{
+			if (Mesh* mesh = FindMesh(child))
+				return mesh;
+		}
+
+		return nullptr;
+	}
+
+	struct GeneratedNode
+	{
+		GameObject* object;
+		glm::vec3 position;
+	};
+
+	// Drawn for every object before any is created, so the scene can make room for exactly what comes
+	struct GeneratedContent
+	{
+		uint32_t components = 0;
+		int mesh = 0;
+		int texture = 0;
+		bool isStatic = false;
+	};
+}
+
+GameObject* SceneGenerator::Generate(const StressSceneSettings& settings, GameObject* parent)
+{
+	Timer timer;
+
+	LoadPrimitives();
+	CreateTextures(settings.textures);
+
+	ModuleScene* scene = app->scene;
+
+	const int count = std::max(settings.objects, 1);
+	const int depth = std::max(settings.depth, 1);
+	const int branching = std::max(settings.branching, 1);
+	const int meshKinds = std::min(std::max(settings.meshKinds, 0), (int)primitives.size());
+	const int textureCount = std::min(std::max(settings.textures, 0), (int)textures.size());
+
+	std::mt19937 random((unsigned int)settings.seed);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	std::vector<GeneratedContent> contents(count);
+	ObjectReservation reservation;
+	// The generated root, nothing but a transform
+	reservation.Add(0);
+
+	int meshObjects = 0;
+	int staticObjects = 0;
+
+	for (GeneratedContent& content : contents)
+	{
+		if (meshKinds > 0 && unit(random) < settings.meshRatio)
+		{
+			content.components = COMPONENT_BIT(ComponentType::MESH);
+			content.mesh = random() % meshKinds;
+
+			if (textureCount > 0)
+			{
+				content.components |= COMPONENT_BIT(ComponentType::MATERIAL);
+				content.texture = random() % textureCount;
+			}
+
+			++meshObjects;
+		}
+
+		if (unit(random) < settings.staticRatio)
+		{
+			content.isStatic = true;
+			++staticObjects;
+		}
+
+		reservation.Add(content.components);
+	}
+
+	scene->ReserveObjects(reservation);
+	scene->BeginBulkCreate();
+
+	GameObject* generatedRoot = scene->CreateGameObject("Stress Scene", parent);
+
+	// Every object takes the next cell of a cube grid, its local position is the offset from its parent's cell
+	const int side = (int)std::ceil(std::cbrt((float)count));
+	const float offset = (side - 1) * settings.spacing * 0.5f;
+
+	std::vector<GeneratedNode> level = { { generatedRoot, glm::vec3(0.0f) } };
+	std::vector<GeneratedNode> nextLevel;
+
+	int created = 0;
+	int levels = 0;
+	char name[32];
+
+	for (int levelDepth = 1; created < count; ++levelDepth)
+	{
+		levels = levelDepth;
+
+		int levelCount = count - created;
+		if (levelDepth < depth)
+			levelCount = (int)std::min<long long>(levelCount, (long long)level.size() * branching);
+
+		// Parents take children in turns, the last level spreads evenly over the one above it
+		const int childrenPerParent = levelCount / (int)level.size() + 1;
+		for (GeneratedNode& node : level)
+			node.object->children.reserve(childrenPerParent);
+
+		nextLevel.clear();
+		nextLevel.reserve(levelCount);
+
+		for (int i = 0; i < levelCount; ++i, ++created)
+		{
+			const GeneratedNode& parentNode = level[i % level.size()];
+			const GeneratedContent& content = contents[created];
+
+			snprintf(name, sizeof(name), "Stress %d", created);
+			GameObject* object = scene->CreateGameObject(name, parentNode.object, content.components);
+
+			glm::vec3 position(
+				(created % side) * settings.spacing - offset,
+				((created / side) % side) * settings.spacing,
+				(created / (side * side)) * settings.spacing - offset
+			);
+			scene->transforms.SetLocal(object->transform->id, position - parentNode.position, glm::quat(1.0f, 0.0f, 0.0f, 0.0f), glm::vec3(1.0f));
+
+			if (object->mesh != nullptr)
+				object->mesh->SetMesh(primitives[content.mesh]);
+			if (object->material != nullptr)
+				object->material->SetTexture(textures[content.texture]);
+			object->isStatic = content.isStatic;
+
+			nextLevel.push_back({ object, position });
+		}
+
+		level.swap(nextLevel);
+	}
+
+	scene->EndBulkCreate();
+
+	LOG(LogType::LOG_INFO, "Stress scene: %d objects (%d with a mesh, %d static) over %d levels, %d mesh kinds, %d textures in %.2f ms",
+		count, meshObjects, staticObjects, levels, meshKinds, textureCount, timer.ReadMs());
+
+	return generatedRoot;
+}
+
+void SceneGenerator::LoadPrimitives()
+{
+	if (primitivesLoaded)
+		return;
+
+	primitivesLoaded = true;
+
+	for (const char* path : PRIMITIVE_PATHS)
+	{
+		Resource* resource = app->resources->FindResourceInLibrary(path, ResourceType::MODEL);
+		if (!resource)
+			resource = app->importer->ImportFileToLibrary(path, ResourceType::MODEL);
+
+		// Loaded under an object outside the scene only to reach the mesh, which outlives it
+		GameObject* holder = app->scene->CreateGameObject("Primitive", nullptr);
+
+		Mesh* mesh = nullptr;
+		if (resource && app->importer->modelImporter->LoadModel(resource, holder))
+			mesh = FindMesh(holder);
+
+		app->scene->DestroyGameObject(holder);
+
+		if (mesh != nullptr)
+			primitives.push_back(mesh);
+		else
+			LOG(LogType::LOG_WARNING, "Stress scene: could not load %s", path);
+	}
+}
+
+Texture* SceneGenerator::FindTexture(const char* path)
+{
+	if (!IsGeneratedTexture(path))
+		return nullptr;
+
+	// The same number always gives the same pattern, so it doesn't matter which session made it first
+	const int index = atoi(path + strlen(STRESS_TEXTURE_PREFIX));
+	if (index < 0 || index >= STRESS_MAX_TEXTURES)
+		return nullptr;
+
+	CreateTextures(index + 1);
+
+	return textures[index];
+}
+
+bool SceneGenerator::IsGeneratedTexture(const char* path)
+{
+	return path != nullptr && strncmp(path, STRESS_TEXTURE_PREFIX, strlen(STRESS_TEXTURE_PREFIX)) == 0;
+}
+
+void SceneGenerator::CreateTextures(int count)
+{
+	if (count > STRESS_MAX_TEXTURES)
+		count = STRESS_MAX_TEXTURES;
+
+	if ((int)textures.size() >= count)
+		return;
+
+	GLContextLock lock(app->renderer3D->renderThread);
+
+	std::vector<GLubyte> pixels(STRESS_TEXTURE_SIZE * STRESS_TEXTURE_SIZE * 4);
+	char path[64];
+
+	// A checker pattern in a different tint each, so the textures are told apart on screen
+	for (int t = (int)textures.size(); t < count; ++t)
+	{
+		const GLubyte tint[3] = { (GLubyte)(64 + (t * 97) % 192), (GLubyte)(64 + (t * 57) % 192), (GLubyte)(64 + (t * 31) % 192) };
+
+		for (int y = 0; y < STRESS_TEXTURE_SIZE; ++y)
+		{
+			for (int x = 0; x < STRESS_TEXTURE_SIZE; ++x)
+			{
+				GLubyte* pixel = &pixels[(y * STRESS_TEXTURE_SIZE + x) * 4];
+				const bool dark = ((x / 8) + (y / 8)) % 2 == 0;
+
+				for (int c = 0; c < 3; ++c)
+					pixel[c] = dark ? tint[c] / 2 : tint[c];
+				pixel[3] = 255;
+			}
+		}
+
+		GLuint textureId;
+		glGenTextures(1, &textureId);
+		glBindTexture(GL_TEXTURE_2D, textureId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, STRESS_TEXTURE_SIZE, STRESS_TEXTURE_SIZE, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		// Keyed so saved scenes and Play snapshots keep them, see FindTexture
+		snprintf(path, sizeof(path), STRESS_TEXTURE_PREFIX "%d", t);
+		textures.push_back(new Texture(textureId, STRESS_TEXTURE_SIZE, STRESS_TEXTURE_SIZE, path));
+	}
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
\ No newline at end of file
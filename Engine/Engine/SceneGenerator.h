@@ -0,0 +1,55 @@
+#pragma once
+
+#include <vector>
+
+class GameObject;
+class Mesh;
+class Texture;
+
+// Cube, Sphere, Cylinder and Capsule from Engine/Primitives
+#define STRESS_PRIMITIVE_COUNT 4
+#define STRESS_TEXTURE_SIZE 32
+// Generated textures have no file, this plus their number is the path scenes refer to them by
+#define STRESS_TEXTURE_PREFIX "Generated/Stress Texture "
+#define STRESS_MAX_TEXTURES 4096
+
+struct StressSceneSettings
+{
+	int objects = 10000;
+	// Levels below the generated root. Every level but the last is at most branching times wider
+	// than the one above, the last takes whatever is left
+	int depth = 3;
+	int branching = 16;
+	// Share of objects with a mesh, the rest are empty group nodes
+	float meshRatio = 0.9f;
+	// How many of the primitives are mixed in
+	int meshKinds = STRESS_PRIMITIVE_COUNT;
+	// Procedural textures spread over the meshes, 0 leaves them untextured
+	int textures = 4;
+	float staticRatio = 0.25f;
+	float spacing = 3.0f;
+	int seed = 1;
+};
+
+// Builds procedural scenes of any size from the engine primitives, the same settings always give the
+// same scene. Meshes and textures are loaded once and shared by every scene generated after
+class SceneGenerator
+{
+public:
+	GameObject* Generate(const StressSceneSettings& settings, GameObject* parent);
+
+	// The generated texture a path under STRESS_TEXTURE_PREFIX stands for, made again if this session
+	// has not made it yet. Null for any other path
+	Texture* FindTexture(const char* path);
+	// Whether a texture path is one of the generated keys rather than a file
+	static bool IsGeneratedTexture(const char* path);
+
+private:
+	void LoadPrimitives();
+	void CreateTextures(int count);
+
+private:
+	std::vector<Mesh*> primitives;
+	std::vector<Texture*> textures;
+	bool primitivesLoaded = false;
+};
\ No newline at end of file
@@ -0,0 +1,441 @@
+#include "SceneSerializer.h"
+#include "App.h"
+#include "Timer.h"
+
+#include <windows.h>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+namespace
+{
+	// Read-only view of a whole file, unmapped when it goes out of scope
+	class MappedFile
+	{
+	public:
+		MappedFile(const std::string& filePath)
+		{
+			file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			if (file == INVALID_HANDLE_VALUE)
+				return;
+
+			LARGE_INTEGER fileSize;
+			if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+				return;
+
+			mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+			if (mapping == NULL)
+				return;
+
+			data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+			if (data != nullptr)
+				size = (size_t)fileSize.QuadPart;
+		}
+
+		~MappedFile()
+		{
+			if (data != nullptr)
+				UnmapViewOfFile(data);
+			if (mapping != NULL)
+				CloseHandle(mapping);
+			if (file != INVALID_HANDLE_VALUE)
+				CloseHandle(file);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data = nullptr;
+		size_t size = 0;
+
+	private:
+		HANDLE file = INVALID_HANDLE_VALUE;
+		HANDLE mapping = NULL;
+	};
+
+	uint32_t AddString(std::string& strings, const char* value)
+	{
+		uint32_t offset = (uint32_t)strings.size();
+		strings.append(value);
+		strings.push_back('\0');
+		return offset;
+	}
+
+	// The components besides the transform a node is created with
+	uint32_t NodeComponents(uint32_t flags)
+	{
+		return ((flags & SCENE_NODE_MESH) ? COMPONENT_BIT(ComponentType::MESH) : 0)
+			| ((flags & SCENE_NODE_MATERIAL) ? COMPONENT_BIT(ComponentType::MATERIAL) : 0);
+	}
+}
+
+void SceneSerializer::Write(const GameObject* root, std::vector<char>& buffer)
+{
+	EntityRegistry& entities = app->scene->entities;
+	TransformHierarchy& transforms = app->scene->transforms;
+
+	std::vector<SceneFileNode> nodes;
+	std::vector<uint32_t> meshPaths;
+	std::vector<uint32_t> texturePaths;
+	std::string strings;
+
+	std::unordered_map<const Mesh*, uint32_t> meshIndices;
+	std::unordered_map<const Texture*, uint32_t> textureIndices;
+
+	nodes.reserve(app->scene->gameObjects.GetLiveCount());
+
+	// Depth first with an explicit stack, parents are written before their children
+	std::vector<std::pair<const GameObject*, uint32_t>> stack;
+	stack.emplace_back(root, SCENE_FILE_NONE);
+
+	while (!stack.empty())
+	{
+		const GameObject* object = stack.back().first;
+		const uint32_t parentIndex = stack.back().second;
+		stack.pop_back();
+
+		const uint32_t index = (uint32_t)nodes.size();
+
+		SceneFileNode node;
+		node.parent = parentIndex;
+		node.childCount = (uint32_t)object->children.size();
+		node.name = AddString(strings, object->name.c_str());
+
+		if (object->isActive)
+			node.flags |= SCENE_NODE_ACTIVE;
+		if (object->isStatic)
+			node.flags |= SCENE_NODE_STATIC;
+
+		const TransformId transformId = object->transform->id;
+		const glm::vec3& position = transforms.GetPosition(transformId);
+		const glm::quat& rotation = transforms.GetRotation(transformId);
+		const glm::vec3& scale = transforms.GetScale(transformId);
+
+		for (int i = 0; i < 3; ++i)
+		{
+			node.position[i] = position[i];
+			node.scale[i] = scale[i];
+		}
+		node.rotation[0] = rotation.x;
+		node.rotation[1] = rotation.y;
+		node.rotation[2] = rotation.z;
+		node.rotation[3] = rotation.w;
+
+		if (object->mesh != nullptr)
+		{
+			const MeshData& meshData = entities.GetMesh(object->entity);
+			node.flags |= SCENE_NODE_MESH;
+			if (meshData.showVertexNormals)
+				node.flags |= SCENE_NODE_VERTEX_NORMALS;
+			if (meshData.showFaceNormals)
+				node.flags |= SCENE_NODE_FACE_NORMALS;
+
+			// Meshes that didn't come from a file can't be referenced, the node keeps an empty component
+			if (meshData.mesh != nullptr && !meshData.mesh->libraryFilePath.empty())
+			{
+				auto found = meshIndices.find(meshData.mesh);
+				if (found == meshIndices.end())
+				{
+					found = meshIndices.emplace(meshData.mesh, (uint32_t)meshPaths.size()).first;
+					meshPaths.push_back(AddString(strings, meshData.mesh->libraryFilePath.c_str()));
+				}
+				node.mesh = found->second;
+			}
+		}
+
+		if (object->material != nullptr)
+		{
+			const MaterialData& materialData = entities.GetMaterial(object->entity);
+			node.flags |= SCENE_NODE_MATERIAL;
+			if (materialData.showCheckersTexture)
+				node.flags |= SCENE_NODE_CHECKERS;
+
+			if (materialData.texture != nullptr && materialData.texture->texturePath != nullptr)
+			{
+				auto found = textureIndices.find(materialData.texture);
+				if (found == textureIndices.end())
+				{
+					found = textureIndices.emplace(materialData.texture, (uint32_t)texturePaths.size()).first;
+					texturePaths.push_back(AddString(strings, materialData.texture->texturePath));
+				}
+				node.texture = found->second;
+			}
+		}
+
+		nodes.push_back(node);
+
+		// Reversed so the children come back out in order
+		for (auto child = object->children.rbegin(); child != object->children.rend(); ++child)
+			stack.emplace_back(*child, index);
+	}
+
+	// Strings last, padded so the file size stays a multiple of 4
+	while (strings.size() % 4 != 0)
+		strings.push_back('\0');
+
+	SceneFileHeader header;
+	header.nodeCount = (uint32_t)nodes.size();
+	header.meshCount = (uint32_t)meshPaths.size();
+	header.textureCount = (uint32_t)texturePaths.size();
+	header.stringsSize = (uint32_t)strings.size();
+
+	const size_t nodesBytes = nodes.size() * sizeof(SceneFileNode);
+	const size_t meshesBytes = meshPaths.size() * sizeof(uint32_t);
+	const size_t texturesBytes = texturePaths.size() * sizeof(uint32_t);
+
+	buffer.resize(sizeof(header) + nodesBytes + meshesBytes + texturesBytes + strings.size());
+
+	char* cursor = buffer.data();
+	memcpy(cursor, &header, sizeof(header));
+	cursor += sizeof(header);
+	memcpy(cursor, nodes.data(), nodesBytes);
+	cursor += nodesBytes;
+	memcpy(cursor, meshPaths.data(), meshesBytes);
+	cursor += meshesBytes;
+	memcpy(cursor, texturePaths.data(), texturesBytes);
+	cursor += texturesBytes;
+	memcpy(cursor, strings.data(), strings.size());
+}
+
+GameObject* SceneSerializer::Read(const char* data, size_t size, GameObject* parent)
+{
+	SceneFileHeader header;
+	if (data == nullptr || size < sizeof(header))
+	{
+		LOG(LogType::LOG_ERROR, "Scene data is too small to be a scene");
+		return nullptr;
+	}
+
+	memcpy(&header, data, sizeof(header));
+	if (header.magic != SCENE_FILE_MAGIC || header.version != SCENE_FILE_VERSION)
+	{
+		LOG(LogType::LOG_ERROR, "Not a scene or an unsupported version (%u)", header.version);
+		return nullptr;
+	}
+
+	const size_t requiredSize = sizeof(header) + (size_t)header.nodeCount * sizeof(SceneFileNode)
+		+ ((size_t)header.meshCount + header.textureCount) * sizeof(uint32_t) + header.stringsSize;
+
+	if (header.nodeCount == 0 || header.stringsSize == 0 || requiredSize > size)
+	{
+		LOG(LogType::LOG_ERROR, "Scene data is truncated");
+		return nullptr;
+	}
+
+	// Used in place, the sections are 4-byte aligned and the buffers themselves more than that
+	const SceneFileNode* nodes = reinterpret_cast<const SceneFileNode*>(data + sizeof(header));
+	const uint32_t* meshPaths = reinterpret_cast<const uint32_t*>(nodes + header.nodeCount);
+	const uint32_t* texturePaths = meshPaths + header.meshCount;
+	const char* strings = reinterpret_cast<const char*>(texturePaths + header.textureCount);
+
+	// Every string has to end inside the block, and only the first node may lack a parent that comes before it
+	if (strings[header.stringsSize - 1] != '\0')
+	{
+		LOG(LogType::LOG_ERROR, "Scene strings are not terminated");
+		return nullptr;
+	}
+
+	for (uint32_t i = 0; i < header.meshCount + header.textureCount; ++i)
+	{
+		if (meshPaths[i] >= header.stringsSize)
+		{
+			LOG(LogType::LOG_ERROR, "Scene resource %u is corrupt", i);
+			return nullptr;
+		}
+	}
+
+	ObjectReservation reservation;
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		const SceneFileNode& node = nodes[i];
+		const bool validParent = i == 0 ? node.parent == SCENE_FILE_NONE : node.parent < i;
+		if (node.name >= header.stringsSize || !validParent)
+		{
+			LOG(LogType::LOG_ERROR, "Scene node %u is corrupt", i);
+			return nullptr;
+		}
+
+		reservation.Add(NodeComponents(node.flags));
+	}
+
+	ModuleScene* scene = app->scene;
+	EntityRegistry& entities = scene->entities;
+
+	// Resources already in the scene are reused, only the rest is read from disk
+	std::unordered_map<std::string, Mesh*> loadedMeshes;
+	std::unordered_map<std::string, Texture*> loadedTextures;
+
+	entities.ForEach(COMPONENT_BIT(ComponentType::MESH), [&loadedMeshes](Archetype& archetype)
+		{
+			for (const MeshData& meshData : archetype.meshes)
+			{
+				if (meshData.mesh != nullptr && !meshData.mesh->libraryFilePath.empty())
+					loadedMeshes.emplace(meshData.mesh->libraryFilePath, meshData.mesh);
+			}
+		});
+	entities.ForEach(COMPONENT_BIT(ComponentType::MATERIAL), [&loadedTextures](Archetype& archetype)
+		{
+			for (const MaterialData& materialData : archetype.materials)
+			{
+				if (materialData.texture != nullptr && materialData.texture->texturePath != nullptr)
+					loadedTextures.emplace(materialData.texture->texturePath, materialData.texture);
+			}
+		});
+
+	std::vector<Mesh*> meshes(header.meshCount, nullptr);
+	std::vector<uint32_t> missingMeshes;
+	std::vector<std::string> missingMeshPaths;
+
+	for (uint32_t i = 0; i < header.meshCount; ++i)
+	{
+		auto found = loadedMeshes.find(strings + meshPaths[i]);
+		if (found != loadedMeshes.end())
+		{
+			meshes[i] = found->second;
+		}
+		else
+		{
+			missingMeshes.push_back(i);
+			missingMeshPaths.emplace_back(strings + meshPaths[i]);
+		}
+	}
+
+	if (!missingMeshPaths.empty())
+	{
+		std::vector<Mesh*> read = app->importer->modelImporter->LoadMeshes(missingMeshPaths);
+		for (size_t i = 0; i < read.size(); ++i)
+		{
+			meshes[missingMeshes[i]] = read[i];
+			if (read[i] == nullptr)
+				LOG(LogType::LOG_WARNING, "Scene mesh not found: %s", missingMeshPaths[i].c_str());
+		}
+	}
+
+	std::vector<Texture*> textures(header.textureCount, nullptr);
+	for (uint32_t i = 0; i < header.textureCount; ++i)
+	{
+		const char* texturePath = strings + texturePaths[i];
+
+		auto found = loadedTextures.find(texturePath);
+		if (found != loadedTextures.end())
+		{
+			textures[i] = found->second;
+			continue;
+		}
+
+		// Generated textures have no file, the generator makes them again from the path
+		textures[i] = app->scene->generator.FindTexture(texturePath);
+		if (textures[i] != nullptr)
+			continue;
+
+		Resource* resource = app->resources->FindResourceInLibrary(texturePath, ResourceType::TEXTURE);
+		if (resource != nullptr)
+		{
+			textures[i] = app->importer->textureImporter->LoadTextureImage(resource);
+			delete resource;
+		}
+
+		if (textures[i] == nullptr)
+			LOG(LogType::LOG_WARNING, "Scene texture not found: %s", texturePath);
+	}
+
+	scene->ReserveObjects(reservation);
+
+	std::vector<GameObject*> created(header.nodeCount, nullptr);
+
+	// Every entity goes straight into its archetype, the names are indexed together at the end
+	scene->BeginBulkCreate();
+
+	for (uint32_t i = 0; i < header.nodeCount; ++i)
+	{
+		const SceneFileNode& node = nodes[i];
+
+		GameObject* nodeParent = node.parent != SCENE_FILE_NONE ? created[node.parent] : parent;
+		GameObject* object = scene->CreateGameObject(strings + node.name, nodeParent, NodeComponents(node.flags));
+		object->children.reserve(node.childCount);
+
+		// Before any child exists, so they start disabled with it
+		if (!(node.flags & SCENE_NODE_ACTIVE))
+			object->SetActive(false);
+		object->isStatic = (node.flags & SCENE_NODE_STATIC) != 0;
+
+		scene->transforms.SetLocal(object->transform->id,
+			glm::vec3(node.position[0], node.position[1], node.position[2]),
+			glm::quat(node.rotation[3], node.rotation[0], node.rotation[1], node.rotation[2]),
+			glm::vec3(node.scale[0], node.scale[1], node.scale[2]));
+
+		if (node.flags & SCENE_NODE_MESH)
+		{
+			MeshData& meshData = entities.GetMesh(object->entity);
+			meshData.mesh = node.mesh < header.meshCount ? meshes[node.mesh] : nullptr;
+			meshData.showVertexNormals = (node.flags & SCENE_NODE_VERTEX_NORMALS) != 0;
+			meshData.showFaceNormals = (node.flags & SCENE_NODE_FACE_NORMALS) != 0;
+		}
+
+		if (node.flags & SCENE_NODE_MATERIAL)
+		{
+			object->material->SetTexture(node.texture < header.textureCount ? textures[node.texture] : nullptr);
+
+			if (node.flags & SCENE_NODE_CHECKERS)
+			{
+				MaterialData& materialData = entities.GetMaterial(object->entity);
+				materialData.showCheckersTexture = true;
+				materialData.textureId = app->renderer3D->checkerTextureId;
+			}
+		}
+
+		created[i] = object;
+	}
+
+	scene->EndBulkCreate();
+
+	return created[0];
+}
+
+bool SceneSerializer::Save(const GameObject* root, const std::string& filePath)
+{
+	Timer timer;
+
+	std::vector<char> buffer;
+	Write(root, buffer);
+	double writeMs = timer.ReadMs();
+
+	std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+	if (!file.is_open() || !file.write(buffer.data(), buffer.size()))
+	{
+		LOG(LogType::LOG_ERROR, "Failed to write scene: %s", filePath.c_str());
+		return false;
+	}
+	file.close();
+
+	const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(buffer.data());
+	LOG(LogType::LOG_INFO, "Scene saved to %s: %u objects, %u meshes, %u textures, %.1f KB in %.2f ms (%.2f ms serializing)",
+		filePath.c_str(), header->nodeCount, header->meshCount, header->textureCount, buffer.size() / 1024.0, timer.ReadMs(), writeMs);
+
+	return true;
+}
+
+GameObject* SceneSerializer::Load(const std::string& filePath, GameObject* parent)
+{
+	Timer timer;
+
+	MappedFile file(filePath);
+	if (file.data == nullptr)
+	{
+		LOG(LogType::LOG_ERROR, "Failed to map scene: %s", filePath.c_str());
+		return nullptr;
+	}
+
+	GameObject* root = Read(file.data, file.size, parent);
+	if (root == nullptr)
+	{
+		LOG(LogType::LOG_ERROR, "Failed to load scene: %s", filePath.c_str());
+		return nullptr;
+	}
+
+	const SceneFileHeader* header = reinterpret_cast<const SceneFileHeader*>(file.data);
+	LOG(LogType::LOG_INFO, "Scene loaded from %s: %u objects, %.1f KB in %.2f ms",
+		filePath.c_str(), header->nodeCount, file.size / 1024.0, timer.ReadMs());
+
+	return root;
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class GameObject;
+
+#define SCENE_FILE_MAGIC 0x4E435353u // "SSCN"
+#define SCENE_FILE_VERSION 1u
+#define SCENE_FILE_NONE 0xFFFFFFFFu
+
+enum SceneNodeFlags : uint32_t
+{
+	SCENE_NODE_ACTIVE = 1 << 0,
+	SCENE_NODE_STATIC = 1 << 1,
+	SCENE_NODE_MESH = 1 << 2,
+	SCENE_NODE_MATERIAL = 1 << 3,
+	SCENE_NODE_VERTEX_NORMALS = 1 << 4,
+	SCENE_NODE_FACE_NORMALS = 1 << 5,
+	SCENE_NODE_CHECKERS = 1 << 6,
+};
+
+// A .scene file is the header followed by the nodes, the mesh and texture path offsets and one block
+// of null-terminated strings. Everything is fixed size and 4-byte aligned so a mapped file is read in
+// place
+struct SceneFileHeader
+{
+	uint32_t magic = SCENE_FILE_MAGIC;
+	uint32_t version = SCENE_FILE_VERSION;
+	uint32_t nodeCount = 0;
+	uint32_t meshCount = 0;
+	uint32_t textureCount = 0;
+	uint32_t stringsSize = 0;
+};
+
+// Nodes are stored parents first, so a parent index always points back
+struct SceneFileNode
+{
+	uint32_t parent = SCENE_FILE_NONE;
+	uint32_t childCount = 0;
+	// Offset into the strings
+	uint32_t name = 0;
+	// Indices into the mesh and texture tables
+	uint32_t mesh = SCENE_FILE_NONE;
+	uint32_t texture = SCENE_FILE_NONE;
+	uint32_t flags = 0;
+
+	float position[3] = {};
+	// x, y, z, w
+	float rotation[4] = {};
+	float scale[3] = {};
+};
+
+// Binary scenes. Meshes are referenced by the library file they were read from and textures by their
+// asset path, whatever is already loaded is reused instead of read again
+class SceneSerializer
+{
+public:
+	// The subtree under root, root included
+	static void Write(const GameObject* root, std::vector<char>& buffer);
+	// Builds the subtree back under parent, or as a new root when parent is null. Null if the data is
+	// not a scene
+	static GameObject* Read(const char* data, size_t size, GameObject* parent);
+
+	// Write plus a single write to disk
+	static bool Save(const GameObject* root, const std::string& filePath);
+	// Maps the file and reads it in place
+	static GameObject* Load(const std::string& filePath, GameObject* parent);
+};
\ No newline at end of file
@@ -53,15 +53,13 @@ void SceneWindow::DrawWindow()
 
 	UpdateMouseState();
 
-	ImVec2 textureSize = ImVec2((float)app->window->width, (float)app->window->height);
 	ImVec2 windowSize = ImGui::GetWindowSize();
+	ImVec2 viewportSize = ImGui::GetContentRegionAvail();
 
-	ImVec2 uv0 = ImVec2((textureSize.x - windowSize.x) / (2 * textureSize.x),
-		(textureSize.y + windowSize.y) / (2 * textureSize.y));
-	ImVec2 uv1 = ImVec2((textureSize.x + windowSize.x) / (2 * textureSize.x),
-		(textureSize.y - windowSize.y) / (2 * textureSize.y));
+	// The render target matches the panel, so the whole texture is shown (flipped, GL origin is bottom left)
+	app->renderer3D->SetSceneViewportSize((int)viewportSize.x, (int)viewportSize.y);
 
-	ImGui::Image((void*)(intptr_t)app->renderer3D->fboTexture, windowSize, uv0, uv1);
+	ImGui::Image((void*)(intptr_t)app->renderer3D->fboTexture, viewportSize, ImVec2(0, 1), ImVec2(1, 0));
 
 	if (ImGui::BeginDragDropTarget())
 	{
@@ -0,0 +1,155 @@
+#include "Shader.h"
+#include "ShaderCache.h"
+#include "Logger.h"
+
+#include <glm/gtc/type_ptr.hpp>
+#include <fstream>
+#include <sstream>
+
+Shader::Shader() : programId(0), loadedFromCache(false)
+{
+}
+
+Shader::~Shader()
+{
+}
+
+bool Shader::LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath, ShaderCache* cache)
+{
+	std::string vertexSource;
+	std::string fragmentSource;
+
+	if (!ReadFile(vertexPath, vertexSource) || !ReadFile(fragmentPath, fragmentSource))
+		return false;
+
+	bool useCache = cache != nullptr && cache->IsAvailable();
+
+	if (useCache)
+	{
+		CleanUp();
+
+		programId = cache->LoadProgram(vertexSource, fragmentSource);
+		if (programId != 0)
+		{
+			loadedFromCache = true;
+			return true;
+		}
+	}
+
+	if (!Compile(vertexSource.c_str(), fragmentSource.c_str(), useCache))
+		return false;
+
+	if (useCache)
+		cache->SaveProgram(programId, vertexSource, fragmentSource);
+
+	return true;
+}
+
+bool Shader::Compile(const char* vertexSource, const char* fragmentSource, bool retrievable)
+{
+	CleanUp();
+	loadedFromCache = false;
+
+	GLuint vertexShader = CompileStage(GL_VERTEX_SHADER, vertexSource);
+	GLuint fragmentShader = CompileStage(GL_FRAGMENT_SHADER, fragmentSource);
+
+	if (vertexShader == 0 || fragmentShader == 0)
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return false;
+	}
+
+	programId = glCreateProgram();
+	glAttachShader(programId, vertexShader);
+	glAttachShader(programId, fragmentShader);
+
+	// Without the hint some drivers hand back an empty binary
+	if (retrievable)
+		glProgramParameteri(programId, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+	glLinkProgram(programId);
+
+	glDetachShader(programId, vertexShader);
+	glDetachShader(programId, fragmentShader);
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint linked = GL_FALSE;
+	glGetProgramiv(programId, GL_LINK_STATUS, &linked);
+	if (linked != GL_TRUE)
+	{
+		char infoLog[1024];
+		glGetProgramInfoLog(programId, sizeof(infoLog), nullptr, infoLog);
+		LOG(LogType::LOG_ERROR, "Shader program link error: %s", infoLog);
+		CleanUp();
+		return false;
+	}
+
+	return true;
+}
+
+void Shader::CleanUp()
+{
+	if (programId != 0)
+	{
+		glDeleteProgram(programId);
+		programId = 0;
+	}
+}
+
+void Shader::Use() const
+{
+	glUseProgram(programId);
+}
+
+GLint Shader::GetUniformLocation(const char* name) const
+{
+	return glGetUniformLocation(programId, name);
+}
+
+void Shader::SetInt(const char* name, int value) const
+{
+	glUniform1i(GetUniformLocation(name), value);
+}
+
+void Shader::SetMat4(const char* name, const glm::mat4& matrix) const
+{
+	glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+GLuint Shader::CompileStage(GLenum stage, const char* source)
+{
+	GLuint shader = glCreateShader(stage);
+	glShaderSource(shader, 1, &source, nullptr);
+	glCompileShader(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+	if (compiled != GL_TRUE)
+	{
+		char infoLog[1024];
+		glGetShaderInfoLog(shader, sizeof(infoLog), nullptr, infoLog);
+		LOG(LogType::LOG_ERROR, "%s shader compile error: %s", stage == GL_VERTEX_SHADER ? "Vertex" : "Fragment", infoLog);
+		glDeleteShader(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+bool Shader::ReadFile(const std::string& filePath, std::string& content) const
+{
+	std::ifstream file(filePath);
+	if (!file.is_open())
+	{
+		LOG(LogType::LOG_ERROR, "Failed to open shader file: %s", filePath.c_str());
+		return false;
+	}
+
+	std::stringstream stream;
+	stream << file.rdbuf();
+	content = stream.str();
+
+	return true;
+}
\ No newline at end of file
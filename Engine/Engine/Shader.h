@@ -0,0 +1,34 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <string>
+
+class ShaderCache;
+
+class Shader
+{
+public:
+	Shader();
+	~Shader();
+
+	// With a cache the linked binary is reused across runs and only compiled on a miss
+	bool LoadFromFiles(const std::string& vertexPath, const std::string& fragmentPath, ShaderCache* cache = nullptr);
+	bool Compile(const char* vertexSource, const char* fragmentSource, bool retrievable = false);
+	void CleanUp();
+
+	void Use() const;
+	bool IsValid() const { return programId != 0; }
+
+	GLint GetUniformLocation(const char* name) const;
+	void SetInt(const char* name, int value) const;
+	void SetMat4(const char* name, const glm::mat4& matrix) const;
+
+public:
+	GLuint programId;
+	bool loadedFromCache;
+
+private:
+	GLuint CompileStage(GLenum stage, const char* source);
+	bool ReadFile(const std::string& filePath, std::string& content) const;
+};
\ No newline at end of file
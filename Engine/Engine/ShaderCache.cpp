@@ -0,0 +1,222 @@
+#include "ShaderCache.h"
+#include "Logger.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace
+{
+	// FNV-1a, enough to tell sources apart, the driver string in the header guards against collisions
+	uint64_t HashString(const std::string& text, uint64_t hash = 14695981039346656037ull)
+	{
+		for (unsigned char c : text)
+		{
+			hash ^= c;
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+
+	std::string GetGLString(GLenum name)
+	{
+		const GLubyte* value = glGetString(name);
+		return value ? (const char*)value : "unknown";
+	}
+}
+
+ShaderCache::ShaderCache()
+{
+}
+
+bool ShaderCache::Init()
+{
+	available = false;
+
+	if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+	{
+		LOG(LogType::LOG_WARNING, "Program binaries not supported, shaders will be compiled every run");
+		return false;
+	}
+
+	GLint formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+	if (formats <= 0)
+	{
+		LOG(LogType::LOG_WARNING, "Driver exposes no program binary formats, shaders will be compiled every run");
+		return false;
+	}
+
+	driver = GetGLString(GL_VENDOR) + "|" + GetGLString(GL_RENDERER) + "|" + GetGLString(GL_VERSION);
+
+	std::error_code error;
+	std::filesystem::create_directories(SHADER_CACHE_DIR, error);
+	if (error)
+	{
+		LOG(LogType::LOG_ERROR, "Failed to create shader cache directory: %s", error.message().c_str());
+		return false;
+	}
+
+	// Binaries from another driver would only fail to load, drop them up front
+	std::string cachedDriver;
+	std::ifstream driverFile(SHADER_CACHE_DRIVER_FILE);
+	if (driverFile.is_open())
+		std::getline(driverFile, cachedDriver);
+	driverFile.close();
+
+	if (cachedDriver != driver)
+	{
+		if (!cachedDriver.empty())
+			LOG(LogType::LOG_INFO, "Driver changed, clearing shader cache");
+
+		ClearEntries();
+
+		std::ofstream output(SHADER_CACHE_DRIVER_FILE, std::ios::trunc);
+		output << driver;
+	}
+
+	available = true;
+	return true;
+}
+
+GLuint ShaderCache::LoadProgram(const std::string& vertexSource, const std::string& fragmentSource)
+{
+	if (!available)
+		return 0;
+
+	std::string path = GetEntryPath(vertexSource, fragmentSource);
+
+	std::ifstream file(path, std::ios::binary);
+	if (!file.is_open())
+	{
+		++misses;
+		return 0;
+	}
+
+	uint32_t magic = 0;
+	uint32_t version = 0;
+	uint32_t driverLength = 0;
+	file.read((char*)&magic, sizeof(magic));
+	file.read((char*)&version, sizeof(version));
+	file.read((char*)&driverLength, sizeof(driverLength));
+
+	bool valid = file && magic == SHADER_CACHE_MAGIC && version == SHADER_CACHE_VERSION && driverLength == driver.size();
+
+	std::string entryDriver(valid ? driverLength : 0, '\0');
+	GLenum format = 0;
+	uint32_t binaryLength = 0;
+	std::vector<char> binary;
+
+	if (valid)
+	{
+		file.read(&entryDriver[0], driverLength);
+		file.read((char*)&format, sizeof(format));
+		file.read((char*)&binaryLength, sizeof(binaryLength));
+
+		valid = file && entryDriver == driver && binaryLength > 0;
+	}
+
+	if (valid)
+	{
+		binary.resize(binaryLength);
+		file.read(binary.data(), binaryLength);
+		valid = (bool)file;
+	}
+
+	file.close();
+
+	GLuint programId = 0;
+	if (valid)
+	{
+		programId = glCreateProgram();
+		glProgramBinary(programId, format, binary.data(), (GLsizei)binaryLength);
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(programId, GL_LINK_STATUS, &linked);
+		if (linked != GL_TRUE)
+		{
+			glDeleteProgram(programId);
+			programId = 0;
+		}
+	}
+
+	if (programId == 0)
+	{
+		LOG(LogType::LOG_WARNING, "Discarding stale shader cache entry: %s", path.c_str());
+		std::error_code error;
+		std::filesystem::remove(path, error);
+		++misses;
+		return 0;
+	}
+
+	++hits;
+	return programId;
+}
+
+bool ShaderCache::SaveProgram(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource)
+{
+	if (!available || programId == 0)
+		return false;
+
+	GLint binaryLength = 0;
+	glGetProgramiv(programId, GL_PROGRAM_BINARY_LENGTH, &binaryLength);
+	if (binaryLength <= 0)
+	{
+		LOG(LogType::LOG_WARNING, "Driver returned an empty program binary, shader not cached");
+		return false;
+	}
+
+	std::vector<char> binary(binaryLength);
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinary(programId, binaryLength, &written, &format, binary.data());
+	if (written <= 0)
+		return false;
+
+	std::string path = GetEntryPath(vertexSource, fragmentSource);
+
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (!file.is_open())
+	{
+		LOG(LogType::LOG_ERROR, "Failed to write shader cache entry: %s", path.c_str());
+		return false;
+	}
+
+	uint32_t magic = SHADER_CACHE_MAGIC;
+	uint32_t version = SHADER_CACHE_VERSION;
+	uint32_t driverLength = (uint32_t)driver.size();
+	uint32_t length = (uint32_t)written;
+
+	file.write((const char*)&magic, sizeof(magic));
+	file.write((const char*)&version, sizeof(version));
+	file.write((const char*)&driverLength, sizeof(driverLength));
+	file.write(driver.data(), driverLength);
+	file.write((const char*)&format, sizeof(format));
+	file.write((const char*)&length, sizeof(length));
+	file.write(binary.data(), written);
+
+	return (bool)file;
+}
+
+std::string ShaderCache::GetEntryPath(const std::string& vertexSource, const std::string& fragmentSource) const
+{
+	// The stage separator keeps "ab" + "c" and "a" + "bc" from hashing alike
+	uint64_t hash = HashString(vertexSource);
+	hash = HashString(std::string(1, '\0') + fragmentSource, hash);
+	hash = HashString(driver, hash);
+
+	std::stringstream name;
+	name << SHADER_CACHE_DIR << std::hex << hash << ".shader";
+	return name.str();
+}
+
+void ShaderCache::ClearEntries() const
+{
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(SHADER_CACHE_DIR, error))
+	{
+		if (entry.path().extension() == ".shader")
+			std::filesystem::remove(entry.path(), error);
+	}
+}
\ No newline at end of file
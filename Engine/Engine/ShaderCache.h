@@ -0,0 +1,39 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstdint>
+#include <string>
+
+#define SHADER_CACHE_DIR "Library/Shaders/"
+#define SHADER_CACHE_DRIVER_FILE "Library/Shaders/driver.txt"
+#define SHADER_CACHE_MAGIC 0x43425348 // "HSBC"
+#define SHADER_CACHE_VERSION 1
+
+// Stores linked program binaries in Library/ so later runs skip compiling and linking.
+// Entries are keyed by the shader sources and the driver, a driver update drops them all
+class ShaderCache
+{
+public:
+	ShaderCache();
+
+	// Must run after glewInit, the driver strings are read from the current context
+	bool Init();
+
+	bool IsAvailable() const { return available; }
+
+	// Returns 0 when there is no usable entry, a stale one is deleted
+	GLuint LoadProgram(const std::string& vertexSource, const std::string& fragmentSource);
+	bool SaveProgram(GLuint programId, const std::string& vertexSource, const std::string& fragmentSource);
+
+public:
+	int hits = 0;
+	int misses = 0;
+
+private:
+	std::string GetEntryPath(const std::string& vertexSource, const std::string& fragmentSource) const;
+	void ClearEntries() const;
+
+private:
+	bool available = false;
+	std::string driver;
+};
\ No newline at end of file
@@ -0,0 +1,295 @@
+#include "StaticBatcher.h"
+#include "GameObject.h"
+#include "OcclusionCuller.h"
+#include "ModuleJobs.h"
+#include "GLStateCache.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+
+StaticBatcher::StaticBatcher()
+{
+}
+
+StaticBatcher::~StaticBatcher()
+{
+}
+
+void StaticBatcher::Build(GameObject* root)
+{
+	DeleteBuffers();
+	ResetFlags(root);
+
+	std::vector<GameObject*> statics;
+	CollectStatic(root, statics);
+
+	// Group by texture so each batch needs a single bind, keeping hierarchy order inside a group
+	std::stable_sort(statics.begin(), statics.end(), [](GameObject* a, GameObject* b)
+		{
+			return ComponentMaterial::GetTextureId(a) < ComponentMaterial::GetTextureId(b);
+		});
+
+	size_t first = 0;
+	while (first < statics.size())
+	{
+		GLuint textureId = ComponentMaterial::GetTextureId(statics[first]);
+
+		size_t last = first + 1;
+		while (last < statics.size() && ComponentMaterial::GetTextureId(statics[last]) == textureId)
+			++last;
+
+		BuildBatch(textureId, std::vector<GameObject*>(statics.begin() + first, statics.begin() + last));
+		first = last;
+	}
+
+	batchedObjects = (int)statics.size();
+	dirty = false;
+
+	LOG(LogType::LOG_INFO, "Static batching merged %d objects into %d batches", batchedObjects, (int)batches.size());
+}
+
+void StaticBatcher::Clear(GameObject* root)
+{
+	DeleteBuffers();
+	ResetFlags(root);
+
+	batchedObjects = 0;
+	culledRanges = 0;
+	occludedRanges = 0;
+	dirty = false;
+}
+
+void StaticBatcher::Cull(const Frustum& frustum, const OcclusionCuller* occlusion, ModuleJobs& jobs)
+{
+	culledRanges = 0;
+	occludedRanges = 0;
+
+	for (StaticBatch& batch : batches)
+	{
+		jobs.ParallelFor((int)batch.ranges.size(), [&batch, &frustum, occlusion](int begin, int end)
+			{
+				for (int i = begin; i < end; ++i)
+				{
+					StaticBatchRange& range = batch.ranges[i];
+
+					if (!frustum.IntersectsAABB(range.aabbMin, range.aabbMax))
+						range.cullResult = CullResult::OUTSIDE_FRUSTUM;
+					else if (occlusion != nullptr && !occlusion->IsVisible(range.aabbMin, range.aabbMax))
+						range.cullResult = CullResult::OCCLUDED;
+					else
+						range.cullResult = CullResult::VISIBLE;
+				}
+			}, 64);
+
+		for (const StaticBatchRange& range : batch.ranges)
+		{
+			if (range.cullResult == CullResult::OUTSIDE_FRUSTUM)
+				++culledRanges;
+			else if (range.cullResult == CullResult::OCCLUDED)
+				++occludedRanges;
+		}
+	}
+}
+
+int StaticBatcher::Draw(GLStateCache& state, bool drawTextures, bool wireframe, bool cullface)
+{
+	int drawCalls = 0;
+
+	for (const StaticBatch& batch : batches)
+	{
+		visibleCounts.clear();
+		visibleOffsets.clear();
+
+		GLuint nextIndex = 0;
+
+		for (const StaticBatchRange& range : batch.ranges)
+		{
+			if (range.cullResult != CullResult::VISIBLE)
+				continue;
+
+			// Ranges that are contiguous in the index buffer become one sub-draw
+			if (!visibleCounts.empty() && range.firstIndex == nextIndex)
+			{
+				visibleCounts.back() += range.indexCount;
+			}
+			else
+			{
+				visibleCounts.push_back(range.indexCount);
+				visibleOffsets.push_back((const void*)(uintptr_t)(sizeof(uint32_t) * range.firstIndex));
+			}
+
+			nextIndex = range.firstIndex + range.indexCount;
+		}
+
+		if (visibleCounts.empty())
+			continue;
+
+		bool hasTexture = drawTextures && batch.textureId != 0 && batch.textureId != (GLuint)-1;
+
+		state.UseProgram(0);
+		state.PolygonMode(wireframe ? GL_LINE : GL_FILL);
+		state.SetEnabled(GL_CULL_FACE, cullface);
+		state.SetEnabled(GL_TEXTURE_2D, hasTexture);
+
+		if (hasTexture)
+			state.BindTexture(batch.textureId);
+
+		for (GLuint attribute = 0; attribute < GL_STATE_ATTRIBUTES; ++attribute)
+			state.SetVertexAttribArray(attribute, false);
+
+		state.SetClientState(GL_VERTEX_ARRAY, true);
+		state.SetClientState(GL_NORMAL_ARRAY, true);
+		state.SetClientState(GL_TEXTURE_COORD_ARRAY, true);
+
+		if (state.SetVertexLayout(&batch, 0))
+		{
+			state.BindBuffer(GL_ARRAY_BUFFER, batch.verticesId);
+			glVertexPointer(3, GL_FLOAT, 0, NULL);
+
+			state.BindBuffer(GL_ARRAY_BUFFER, batch.normalsId);
+			glNormalPointer(GL_FLOAT, 0, NULL);
+
+			state.BindBuffer(GL_ARRAY_BUFFER, batch.texCoordsId);
+			glTexCoordPointer(2, GL_FLOAT, 0, NULL);
+		}
+
+		state.BindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indicesId);
+		glMultiDrawElements(GL_TRIANGLES, visibleCounts.data(), GL_UNSIGNED_INT, visibleOffsets.data(), (GLsizei)visibleCounts.size());
+
+		++drawCalls;
+	}
+
+	return drawCalls;
+}
+
+void StaticBatcher::CollectStatic(GameObject* node, std::vector<GameObject*>& statics)
+{
+	if (!node->isActive)
+		return;
+
+	if (node->isStatic && node->GetComponent(ComponentType::MESH) && node->mesh->GetMesh() != nullptr)
+	{
+		Mesh* mesh = node->mesh->GetMesh();
+
+		if (mesh->IsValid() && mesh->normalsCount == mesh->verticesCount && mesh->texCoordsCount == mesh->verticesCount)
+		{
+			statics.push_back(node);
+			node->mesh->SetInStaticBatch(true);
+		}
+	}
+
+	for (GameObject* child : node->children)
+		CollectStatic(child, statics);
+}
+
+void StaticBatcher::ResetFlags(GameObject* node)
+{
+	if (node->mesh != nullptr)
+		node->mesh->SetInStaticBatch(false);
+
+	for (GameObject* child : node->children)
+		ResetFlags(child);
+}
+
+void StaticBatcher::BuildBatch(GLuint textureId, const std::vector<GameObject*>& objects)
+{
+	StaticBatch batch;
+	batch.textureId = textureId;
+
+	for (GameObject* object : objects)
+	{
+		batch.verticesCount += object->mesh->GetMesh()->verticesCount;
+		batch.indicesCount += object->mesh->GetMesh()->indicesCount;
+	}
+
+	std::vector<float> vertices;
+	std::vector<float> normals;
+	std::vector<float> texCoords;
+	std::vector<uint32_t> indices;
+
+	vertices.reserve((size_t)batch.verticesCount * 3);
+	normals.reserve((size_t)batch.verticesCount * 3);
+	texCoords.reserve((size_t)batch.verticesCount * 2);
+	indices.reserve(batch.indicesCount);
+	batch.ranges.reserve(objects.size());
+
+	for (GameObject* object : objects)
+	{
+		const glm::mat4& world = object->transform->GetGlobalTransform();
+		glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(world)));
+
+		Mesh* mesh = object->mesh->GetMesh();
+		uint32_t baseVertex = (uint32_t)(vertices.size() / 3);
+
+		StaticBatchRange range;
+		range.firstIndex = (GLuint)indices.size();
+		range.indexCount = (GLsizei)mesh->indicesCount;
+		range.aabbMin = glm::vec3(FLT_MAX);
+		range.aabbMax = glm::vec3(-FLT_MAX);
+
+		// Vertices are baked into world space so the whole batch draws with the view matrix only
+		for (uint i = 0; i < mesh->verticesCount; ++i)
+		{
+			glm::vec3 position = glm::vec3(world * glm::vec4(mesh->vertices[i * 3], mesh->vertices[i * 3 + 1], mesh->vertices[i * 3 + 2], 1.0f));
+			vertices.push_back(position.x);
+			vertices.push_back(position.y);
+			vertices.push_back(position.z);
+
+			range.aabbMin = glm::min(range.aabbMin, position);
+			range.aabbMax = glm::max(range.aabbMax, position);
+
+			glm::vec3 normal = normalMatrix * glm::vec3(mesh->normals[i * 3], mesh->normals[i * 3 + 1], mesh->normals[i * 3 + 2]);
+			float length = glm::length(normal);
+			if (length > 0.0f)
+				normal /= length;
+
+			normals.push_back(normal.x);
+			normals.push_back(normal.y);
+			normals.push_back(normal.z);
+
+			texCoords.push_back(mesh->texCoords[i * 2]);
+			texCoords.push_back(mesh->texCoords[i * 2 + 1]);
+		}
+
+		for (uint i = 0; i < mesh->indicesCount; ++i)
+			indices.push_back(baseVertex + mesh->indices[i]);
+
+		batch.ranges.push_back(range);
+	}
+
+	glGenBuffers(1, &batch.verticesId);
+	glBindBuffer(GL_ARRAY_BUFFER, batch.verticesId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &batch.normalsId);
+	glBindBuffer(GL_ARRAY_BUFFER, batch.normalsId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * normals.size(), normals.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &batch.texCoordsId);
+	glBindBuffer(GL_ARRAY_BUFFER, batch.texCoordsId);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(float) * texCoords.size(), texCoords.data(), GL_STATIC_DRAW);
+
+	glGenBuffers(1, &batch.indicesId);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, batch.indicesId);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices.size(), indices.data(), GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	batches.push_back(batch);
+}
+
+void StaticBatcher::DeleteBuffers()
+{
+	for (StaticBatch& batch : batches)
+	{
+		glDeleteBuffers(1, &batch.verticesId);
+		glDeleteBuffers(1, &batch.normalsId);
+		glDeleteBuffers(1, &batch.texCoordsId);
+		glDeleteBuffers(1, &batch.indicesId);
+	}
+
+	batches.clear();
+}
\ No newline at end of file
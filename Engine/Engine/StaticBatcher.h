@@ -0,0 +1,71 @@
+#pragma once
+
+#include "Frustum.h"
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+class GameObject;
+class OcclusionCuller;
+class ModuleJobs;
+class GLStateCache;
+
+struct StaticBatchRange
+{
+	GLuint firstIndex = 0;
+	GLsizei indexCount = 0;
+	glm::vec3 aabbMin = glm::vec3(0.0f);
+	glm::vec3 aabbMax = glm::vec3(0.0f);
+	CullResult cullResult = CullResult::VISIBLE;
+};
+
+struct StaticBatch
+{
+	GLuint textureId = 0;
+
+	GLuint verticesId = 0;
+	GLuint normalsId = 0;
+	GLuint texCoordsId = 0;
+	GLuint indicesId = 0;
+
+	unsigned int verticesCount = 0;
+	unsigned int indicesCount = 0;
+
+	// One range per merged object, kept in index order so visible neighbours can be joined
+	std::vector<StaticBatchRange> ranges;
+};
+
+class StaticBatcher
+{
+public:
+	StaticBatcher();
+	~StaticBatcher();
+
+	void Build(GameObject* root);
+	void Clear(GameObject* root);
+	void Cull(const Frustum& frustum, const OcclusionCuller* occlusion, ModuleJobs& jobs);
+	int Draw(GLStateCache& state, bool drawTextures, bool wireframe, bool cullface);
+
+	void MarkDirty() { dirty = true; }
+	bool IsDirty() const { return dirty; }
+	bool IsEmpty() const { return batches.empty(); }
+
+public:
+	int batchedObjects = 0;
+	int culledRanges = 0;
+	int occludedRanges = 0;
+
+private:
+	void CollectStatic(GameObject* node, std::vector<GameObject*>& statics);
+	void ResetFlags(GameObject* node);
+	void BuildBatch(GLuint textureId, const std::vector<GameObject*>& objects);
+	void DeleteBuffers();
+
+private:
+	std::vector<StaticBatch> batches;
+	bool dirty = false;
+
+	std::vector<GLsizei> visibleCounts;
+	std::vector<const void*> visibleOffsets;
+};
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "StreamBuffer.h"
+#include "Logger.h"
+#include "Timer.h"
+
+StreamBuffer::StreamBuffer()
+{
+}
+
+StreamBuffer::~StreamBuffer()
+{
+}
+
+bool StreamBuffer::Init(GLsizeiptr frameSize)
+{
+	if (!GLEW_VERSION_4_4 && !GLEW_ARB_buffer_storage)
+	{
+		LOG(LogType::LOG_WARNING, "Persistent buffer mapping not supported, per-frame data will be orphaned instead");
+		return false;
+	}
+
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr totalSize = frameSize * STREAM_BUFFER_FRAMES;
+
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+	glBufferStorage(GL_COPY_WRITE_BUFFER, totalSize, nullptr, flags);
+	mapped = (char*)glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, totalSize, flags);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	if (mapped == nullptr)
+	{
+		LOG(LogType::LOG_ERROR, "Could not map the stream buffer");
+		CleanUp();
+		return false;
+	}
+
+	this->frameSize = frameSize;
+	segment = 0;
+	head = 0;
+
+	LOG(LogType::LOG_INFO, "Stream buffer created: %d frames of %d KB", STREAM_BUFFER_FRAMES, (int)(frameSize / 1024));
+
+	return true;
+}
+
+void StreamBuffer::CleanUp()
+{
+	for (GLsync& fence : fences)
+	{
+		if (fence != nullptr)
+			glDeleteSync(fence);
+		fence = nullptr;
+	}
+
+	if (buffer != 0)
+	{
+		if (mapped != nullptr)
+		{
+			glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+			glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+			glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+		}
+
+		glDeleteBuffers(1, &buffer);
+	}
+
+	buffer = 0;
+	mapped = nullptr;
+	frameSize = 0;
+}
+
+void StreamBuffer::BeginFrame()
+{
+	if (!IsAvailable())
+		return;
+
+	segment = (segment + 1) % STREAM_BUFFER_FRAMES;
+	head = 0;
+
+	frameBytes = 0;
+	frameStalls = 0;
+	frameStallMs = 0.0f;
+	frameOverflows = 0;
+
+	GLsync& fence = fences[segment];
+	if (fence == nullptr)
+		return;
+
+	// Normally signalled long ago, only a GPU more than two frames behind makes the CPU wait here
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if (result == GL_TIMEOUT_EXPIRED)
+	{
+		Timer stallTimer;
+
+		do
+		{
+			result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+		} while (result == GL_TIMEOUT_EXPIRED);
+
+		frameStalls++;
+		frameStallMs += (float)stallTimer.ReadMs();
+	}
+
+	glDeleteSync(fence);
+	fence = nullptr;
+}
+
+void StreamBuffer::EndFrame()
+{
+	if (!IsAvailable())
+		return;
+
+	fences[segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	bytesStreamed = frameBytes;
+	fenceStalls = frameStalls;
+	fenceStallMs = frameStallMs;
+	overflows = frameOverflows;
+}
+
+StreamAllocation StreamBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	StreamAllocation allocation;
+
+	if (!IsAvailable())
+		return allocation;
+
+	GLsizeiptr start = (head + alignment - 1) / alignment * alignment;
+	if (start + size > frameSize)
+	{
+		frameOverflows++;
+		return allocation;
+	}
+
+	head = start + size;
+	frameBytes += size;
+
+	allocation.offset = segment * frameSize + start;
+	allocation.data = mapped + allocation.offset;
+	allocation.size = size;
+
+	return allocation;
+}
\ No newline at end of file
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <cstddef>
+
+#define STREAM_BUFFER_FRAMES 3
+
+// A slice of this frame's segment. data is written by the CPU, offset is where the GPU reads it
+struct StreamAllocation
+{
+	void* data = nullptr;
+	GLintptr offset = 0;
+	GLsizeiptr size = 0;
+
+	bool IsValid() const { return data != nullptr; }
+};
+
+// Persistently mapped buffer split in one segment per frame in flight. A fence placed at the end of
+// each frame guards its segment, which is only written again once the GPU has passed that fence
+class StreamBuffer
+{
+public:
+	StreamBuffer();
+	~StreamBuffer();
+
+	// Needs GL 4.4 or ARB_buffer_storage, callers keep their own upload path when this fails
+	bool Init(GLsizeiptr frameSize);
+	void CleanUp();
+
+	// Moves to the next segment, waiting for the GPU if it is still reading from it
+	void BeginFrame();
+	void EndFrame();
+
+	// Returns an invalid allocation when the segment is full
+	StreamAllocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 16);
+
+	bool IsAvailable() const { return buffer != 0; }
+	GLuint GetBuffer() const { return buffer; }
+	GLsizeiptr GetFrameSize() const { return frameSize; }
+
+public:
+	// Last completed frame
+	size_t bytesStreamed = 0;
+	int fenceStalls = 0;
+	float fenceStallMs = 0.0f;
+	int overflows = 0;
+
+private:
+	GLuint buffer = 0;
+	char* mapped = nullptr;
+	GLsizeiptr frameSize = 0;
+
+	GLsync fences[STREAM_BUFFER_FRAMES] = {};
+	int segment = 0;
+	GLsizeiptr head = 0;
+
+	size_t frameBytes = 0;
+	int frameStalls = 0;
+	float frameStallMs = 0.0f;
+	int frameOverflows = 0;
+};
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "TextureImporter.h"
+#include "App.h"
 #include "Logger.h"
 
 #include <IL/il.h>
@@ -47,6 +48,8 @@ void TextureImporter::SaveTextureFile(Resource* resource)
 
 Texture* TextureImporter::LoadTextureImage(Resource* resource)
 {
+	GLContextLock lock(app->renderer3D->renderThread);
+
 	ILuint image;
 	ilGenImages(1, &image);
 	ilBindImage(image);
@@ -80,6 +83,8 @@ GLuint TextureImporter::LoadIconImage(const std::string& filePath)
 
 	ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
 
+	GLContextLock lock(app->renderer3D->renderThread);
+
 	GLuint textureID;
 	glGenTextures(1, &textureID);
 	glBindTexture(GL_TEXTURE_2D, textureID);
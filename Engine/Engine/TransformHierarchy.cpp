@@ -0,0 +1,290 @@
+#include "TransformHierarchy.h"
+#include "TransformKernels.h"
+#include "ModuleJobs.h"
+#include "Timer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <type_traits>
+
+// LOCAL_DIRTY: the TRS changed, the local matrix has to be composed again.
+// WORLD_DIRTY: the local matrix is current but the world one is not.
+// CHANGED: the world matrix was rewritten in this pass, children have to follow
+#define TRANSFORM_LOCAL_DIRTY 0x01
+#define TRANSFORM_WORLD_DIRTY 0x02
+#define TRANSFORM_CHANGED 0x04
+#define TRANSFORM_DEAD 0x08
+
+// Below this a batch runs on the calling thread
+#define TRANSFORM_PARALLEL_BATCH 1024
+
+TransformHierarchy::TransformHierarchy()
+{
+}
+
+TransformId TransformHierarchy::Create(TransformId parent)
+{
+	TransformId id;
+	if (!freeIds.empty())
+	{
+		id = freeIds.back();
+		freeIds.pop_back();
+	}
+	else
+	{
+		id = (TransformId)indices.size();
+		indices.push_back(0);
+	}
+
+	int32_t parentIndex = parent != INVALID_TRANSFORM ? (int32_t)indices[parent] : -1;
+	uint16_t depth = parentIndex >= 0 ? depths[parentIndex] + 1 : 0;
+
+	// Appending keeps parents ahead of children, only the depth order is lost
+	if (!depths.empty() && depth < depths.back())
+		orderDirty = true;
+
+	indices[id] = (uint32_t)ids.size();
+
+	ids.push_back(id);
+	parentIds.push_back(parent);
+	parents.push_back(parentIndex);
+	depths.push_back(depth);
+	flags.push_back(TRANSFORM_WORLD_DIRTY);
+	positions.push_back(glm::vec3(0.0f));
+	rotations.push_back(glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+	eulers.push_back(glm::vec3(0.0f));
+	scales.push_back(glm::vec3(1.0f));
+	locals.push_back(glm::mat4(1.0f));
+	worlds.push_back(glm::mat4(1.0f));
+
+	anyDirty = true;
+
+	return id;
+}
+
+void TransformHierarchy::Reserve(int count)
+{
+	if (count <= 0)
+		return;
+
+	const size_t size = ids.size() + count;
+
+	if (freeIds.size() < (size_t)count)
+		indices.reserve(indices.size() + count - freeIds.size());
+
+	ids.reserve(size);
+	parentIds.reserve(size);
+	parents.reserve(size);
+	depths.reserve(size);
+	flags.reserve(size);
+	positions.reserve(size);
+	rotations.reserve(size);
+	eulers.reserve(size);
+	scales.reserve(size);
+	locals.reserve(size);
+	worlds.reserve(size);
+}
+
+void TransformHierarchy::Destroy(TransformId id)
+{
+	// Dropped from the arrays on the next sort, the id is reused only after that
+	flags[indices[id]] |= TRANSFORM_DEAD;
+	releasedIds.push_back(id);
+	orderDirty = true;
+}
+
+void TransformHierarchy::SetLocal(TransformId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+{
+	uint32_t index = indices[id];
+
+	positions[index] = position;
+	rotations[index] = rotation;
+	eulers[index] = glm::degrees(glm::eulerAngles(rotation));
+	scales[index] = scale;
+
+	flags[index] |= TRANSFORM_LOCAL_DIRTY;
+	anyDirty = true;
+}
+
+void TransformHierarchy::SetLocalEuler(TransformId id, const glm::vec3& position, const glm::vec3& eulerDegrees, const glm::vec3& scale)
+{
+	uint32_t index = indices[id];
+
+	positions[index] = position;
+	rotations[index] = glm::quat(glm::radians(eulerDegrees));
+	eulers[index] = eulerDegrees;
+	scales[index] = scale;
+
+	flags[index] |= TRANSFORM_LOCAL_DIRTY;
+	anyDirty = true;
+}
+
+void TransformHierarchy::SetLocalMatrix(TransformId id, const glm::mat4& matrix)
+{
+	uint32_t index = indices[id];
+
+	// Kept as given, the TRS is only what the inspector shows
+	locals[index] = matrix;
+	Decompose(matrix, positions[index], rotations[index], scales[index]);
+	eulers[index] = glm::degrees(glm::eulerAngles(rotations[index]));
+
+	flags[index] = (uint8_t)((flags[index] & ~TRANSFORM_LOCAL_DIRTY) | TRANSFORM_WORLD_DIRTY);
+	anyDirty = true;
+}
+
+void TransformHierarchy::Update(ModuleJobs& jobs)
+{
+	if (orderDirty)
+		SortByDepth();
+
+	if (!anyDirty)
+	{
+		updatedNodes = 0;
+		return;
+	}
+
+	Timer updateTimer;
+
+	const uint32_t count = (uint32_t)ids.size();
+
+	localJobs.clear();
+	worldJobs.clear();
+
+	// Only the flags are walked here, the matrix math runs afterwards in batches
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		uint8_t nodeFlags = flags[i];
+		int32_t parent = parents[i];
+
+		if (nodeFlags & TRANSFORM_LOCAL_DIRTY)
+			localJobs.push_back(i);
+
+		bool parentChanged = parent >= 0 && (flags[parent] & TRANSFORM_CHANGED);
+
+		if ((nodeFlags & (TRANSFORM_LOCAL_DIRTY | TRANSFORM_WORLD_DIRTY)) || parentChanged)
+		{
+			worldJobs.push_back(i);
+			flags[i] = TRANSFORM_CHANGED;
+		}
+		else
+		{
+			flags[i] = 0;
+		}
+	}
+
+	// Local matrices don't depend on each other
+	jobs.ParallelFor((int)localJobs.size(), [this](int begin, int end)
+		{
+			TransformKernels::ComposeTRS(positions.data(), rotations.data(), scales.data(), localJobs.data() + begin, end - begin, locals.data());
+		}, TRANSFORM_PARALLEL_BATCH);
+
+	// Jobs are in depth order and a node only reads the level above it, so each level is split
+	// between the workers once the previous one is done
+	size_t levelBegin = 0;
+	while (levelBegin < worldJobs.size())
+	{
+		const uint16_t depth = depths[worldJobs[levelBegin]];
+
+		size_t levelEnd = levelBegin + 1;
+		while (levelEnd < worldJobs.size() && depths[worldJobs[levelEnd]] == depth)
+			++levelEnd;
+
+		const uint32_t* level = worldJobs.data() + levelBegin;
+		jobs.ParallelFor((int)(levelEnd - levelBegin), [this, level](int begin, int end)
+			{
+				TransformKernels::MultiplyParent(locals.data(), parents.data(), level + begin, end - begin, worlds.data());
+			}, TRANSFORM_PARALLEL_BATCH);
+
+		levelBegin = levelEnd;
+	}
+
+	anyDirty = false;
+	updatedNodes = (int)worldJobs.size();
+	updateMs = (float)updateTimer.ReadMs();
+}
+
+void TransformHierarchy::SortByDepth()
+{
+	order.clear();
+	order.reserve(ids.size());
+
+	for (uint32_t i = 0; i < (uint32_t)ids.size(); ++i)
+	{
+		if (!(flags[i] & TRANSFORM_DEAD))
+			order.push_back(i);
+	}
+
+	// Stable, so siblings keep their creation order
+	std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) { return depths[a] < depths[b]; });
+
+	auto permute = [this](auto& values)
+		{
+			typename std::remove_reference<decltype(values)>::type sorted;
+			sorted.reserve(order.size());
+			for (uint32_t index : order)
+				sorted.push_back(values[index]);
+			values.swap(sorted);
+		};
+
+	permute(ids);
+	permute(parentIds);
+	permute(depths);
+	permute(flags);
+	permute(positions);
+	permute(rotations);
+	permute(eulers);
+	permute(scales);
+	permute(locals);
+	permute(worlds);
+
+	for (uint32_t i = 0; i < (uint32_t)ids.size(); ++i)
+		indices[ids[i]] = i;
+
+	for (TransformId id : releasedIds)
+		indices[id] = INVALID_TRANSFORM;
+
+	parents.resize(ids.size());
+	for (size_t i = 0; i < ids.size(); ++i)
+	{
+		TransformId parent = parentIds[i];
+
+		// Orphans of a destroyed parent hang from the root level from now on
+		if (parent != INVALID_TRANSFORM && indices[parent] == INVALID_TRANSFORM)
+		{
+			parentIds[i] = INVALID_TRANSFORM;
+			flags[i] |= TRANSFORM_WORLD_DIRTY;
+			anyDirty = true;
+			parent = INVALID_TRANSFORM;
+		}
+
+		parents[i] = parent != INVALID_TRANSFORM ? (int32_t)indices[parent] : -1;
+	}
+
+	freeIds.insert(freeIds.end(), releasedIds.begin(), releasedIds.end());
+	releasedIds.clear();
+
+	orderDirty = false;
+}
+
+void TransformHierarchy::Decompose(const glm::mat4& matrix, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale)
+{
+	translation = glm::vec3(matrix[3]);
+
+	glm::vec3 row[3];
+
+	for (int i = 0; i < 3; i++)
+	{
+		row[i] = glm::vec3(matrix[i]);
+	}
+
+	scale.x = glm::length(row[0]);
+	scale.y = glm::length(row[1]);
+	scale.z = glm::length(row[2]);
+
+	if (scale.x != 0) row[0] /= scale.x;
+	if (scale.y != 0) row[1] /= scale.y;
+	if (scale.z != 0) row[2] /= scale.z;
+
+	rotation = glm::quat_cast(glm::mat3(row[0], row[1], row[2]));
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <cstdint>
+#include <vector>
+
+class ModuleJobs;
+
+typedef uint32_t TransformId;
+
+#define INVALID_TRANSFORM 0xFFFFFFFFu
+
+// Every transform in the scene, one array per field. Nodes are kept sorted by depth so a parent is
+// always updated before its children, which lets world matrices be rebuilt in one linear pass over
+// the dirty nodes. Ids stay stable while the arrays are reordered
+class TransformHierarchy
+{
+public:
+	TransformHierarchy();
+
+	// The parent has to exist already, INVALID_TRANSFORM makes a root
+	TransformId Create(TransformId parent);
+	// Children left behind become roots
+	void Destroy(TransformId id);
+	// Room for count more nodes without growing any array
+	void Reserve(int count);
+
+	void SetLocal(TransformId id, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+	// Rotation given as euler angles in degrees, as the inspector edits it
+	void SetLocalEuler(TransformId id, const glm::vec3& position, const glm::vec3& eulerDegrees, const glm::vec3& scale);
+	void SetLocalMatrix(TransformId id, const glm::mat4& matrix);
+
+	const glm::vec3& GetPosition(TransformId id) const { return positions[indices[id]]; }
+	const glm::quat& GetRotation(TransformId id) const { return rotations[indices[id]]; }
+	const glm::vec3& GetEulerDegrees(TransformId id) const { return eulers[indices[id]]; }
+	const glm::vec3& GetScale(TransformId id) const { return scales[indices[id]]; }
+	const glm::mat4& GetLocal(TransformId id) const { return locals[indices[id]]; }
+	// Current as of the last Update
+	const glm::mat4& GetWorld(TransformId id) const { return worlds[indices[id]]; }
+
+	// Restores depth order if nodes were added or removed, then recomputes what changed. Large
+	// batches are split between the job system's workers
+	void Update(ModuleJobs& jobs);
+
+	int GetCount() const { return (int)ids.size(); }
+
+	static void Decompose(const glm::mat4& matrix, glm::vec3& translation, glm::quat& rotation, glm::vec3& scale);
+
+public:
+	// Last Update
+	int updatedNodes = 0;
+	float updateMs = 0.0f;
+
+private:
+	void SortByDepth();
+
+private:
+	// Indexed by id
+	std::vector<uint32_t> indices;
+	std::vector<TransformId> freeIds;
+	std::vector<TransformId> releasedIds;
+
+	// Indexed by position in depth order
+	std::vector<TransformId> ids;
+	std::vector<TransformId> parentIds;
+	std::vector<int32_t> parents;
+	std::vector<uint16_t> depths;
+	std::vector<uint8_t> flags;
+	std::vector<glm::vec3> positions;
+	std::vector<glm::quat> rotations;
+	std::vector<glm::vec3> eulers;
+	std::vector<glm::vec3> scales;
+	std::vector<glm::mat4> locals;
+	std::vector<glm::mat4> worlds;
+
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> localJobs;
+	std::vector<uint32_t> worldJobs;
+
+	bool orderDirty = false;
+	bool anyDirty = false;
+};
\ No newline at end of file
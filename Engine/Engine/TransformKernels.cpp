@@ -0,0 +1,406 @@
+#include "TransformKernels.h"
+#include "Logger.h"
+#include "Timer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <intrin.h>
+#include <immintrin.h>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	SimdLevel DetectLevel()
+	{
+		// SSE2 is part of x64, AVX2 needs the CPU flags and the OS saving the upper halves of the registers.
+		// MSVC emits the intrinsics without /arch, so only the checked paths ever run them
+		int info[4];
+		__cpuidex(info, 0, 0);
+		int maxLeaf = info[0];
+
+		__cpuidex(info, 1, 0);
+		bool fma = (info[2] & (1 << 12)) != 0;
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		bool avx = (info[2] & (1 << 28)) != 0;
+
+		bool avx2 = false;
+		if (maxLeaf >= 7)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+
+		bool ymmSaved = osxsave && (_xgetbv(0) & 6) == 6;
+
+		return (avx && avx2 && fma && ymmSaved) ? SimdLevel::AVX2 : SimdLevel::SSE;
+	}
+
+	SimdLevel& CurrentLevel()
+	{
+		static SimdLevel level = TransformKernels::GetSupportedLevel();
+		return level;
+	}
+
+	// One lane per node, filled from the indexed arrays
+	struct TRSLanes
+	{
+		alignas(32) float px[8], py[8], pz[8];
+		alignas(32) float qx[8], qy[8], qz[8], qw[8];
+		alignas(32) float sx[8], sy[8], sz[8];
+
+		void Gather(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales, const uint32_t* indices, int lanes)
+		{
+			for (int k = 0; k < lanes; ++k)
+			{
+				uint32_t index = indices[k];
+				px[k] = positions[index].x; py[k] = positions[index].y; pz[k] = positions[index].z;
+				qx[k] = rotations[index].x; qy[k] = rotations[index].y; qz[k] = rotations[index].z; qw[k] = rotations[index].w;
+				sx[k] = scales[index].x; sy[k] = scales[index].y; sz[k] = scales[index].z;
+			}
+		}
+	};
+
+	// Rows hold one matrix entry for four nodes, transposing turns them into one column per node
+	inline void StoreColumn(__m128 r0, __m128 r1, __m128 r2, __m128 r3, glm::mat4* out, const uint32_t* indices, int column)
+	{
+		_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+		_mm_storeu_ps(&out[indices[0]][column][0], r0);
+		_mm_storeu_ps(&out[indices[1]][column][0], r1);
+		_mm_storeu_ps(&out[indices[2]][column][0], r2);
+		_mm_storeu_ps(&out[indices[3]][column][0], r3);
+	}
+
+	inline void StoreMatrices(const __m128 m[12], glm::mat4* out, const uint32_t* indices)
+	{
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 one = _mm_set1_ps(1.0f);
+
+		StoreColumn(m[0], m[1], m[2], zero, out, indices, 0);
+		StoreColumn(m[3], m[4], m[5], zero, out, indices, 1);
+		StoreColumn(m[6], m[7], m[8], zero, out, indices, 2);
+		StoreColumn(m[9], m[10], m[11], one, out, indices, 3);
+	}
+}
+
+SimdLevel TransformKernels::GetSupportedLevel()
+{
+	static SimdLevel supported = DetectLevel();
+	return supported;
+}
+
+SimdLevel TransformKernels::GetLevel()
+{
+	return CurrentLevel();
+}
+
+void TransformKernels::SetLevel(SimdLevel level)
+{
+	CurrentLevel() = (int)level <= (int)GetSupportedLevel() ? level : GetSupportedLevel();
+}
+
+const char* TransformKernels::GetLevelName(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::SCALAR: return "Scalar";
+	case SimdLevel::SSE: return "SSE";
+	case SimdLevel::AVX2: return "AVX2";
+	default: return "Unknown";
+	}
+}
+
+void TransformKernels::ComposeTRS(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count, glm::mat4* out)
+{
+	switch (CurrentLevel())
+	{
+	case SimdLevel::AVX2: ComposeAVX2(positions, rotations, scales, indices, count, out); break;
+	case SimdLevel::SSE: ComposeSSE(positions, rotations, scales, indices, count, out); break;
+	default: ComposeScalar(positions, rotations, scales, indices, count, out); break;
+	}
+}
+
+void TransformKernels::MultiplyParent(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds)
+{
+	switch (CurrentLevel())
+	{
+	case SimdLevel::AVX2: MultiplyAVX2(locals, parents, indices, count, worlds); break;
+	case SimdLevel::SSE: MultiplySSE(locals, parents, indices, count, worlds); break;
+	default: MultiplyScalar(locals, parents, indices, count, worlds); break;
+	}
+}
+
+void TransformKernels::ComposeScalar(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count, glm::mat4* out)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t index = indices[i];
+		const glm::quat& q = rotations[index];
+		const glm::vec3& s = scales[index];
+
+		// Same terms as glm::mat3_cast, written out so the scale folds into each column
+		float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		glm::mat4& m = out[index];
+		m[0] = glm::vec4((1.0f - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0.0f);
+		m[1] = glm::vec4((xy - wz) * s.y, (1.0f - (xx + zz)) * s.y, (yz + wx) * s.y, 0.0f);
+		m[2] = glm::vec4((xz + wy) * s.z, (yz - wx) * s.z, (1.0f - (xx + yy)) * s.z, 0.0f);
+		m[3] = glm::vec4(positions[index], 1.0f);
+	}
+}
+
+void TransformKernels::ComposeSSE(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count, glm::mat4* out)
+{
+	TRSLanes lanes;
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		lanes.Gather(positions, rotations, scales, indices + i, 4);
+
+		__m128 x = _mm_load_ps(lanes.qx), y = _mm_load_ps(lanes.qy), z = _mm_load_ps(lanes.qz), w = _mm_load_ps(lanes.qw);
+		__m128 sx = _mm_load_ps(lanes.sx), sy = _mm_load_ps(lanes.sy), sz = _mm_load_ps(lanes.sz);
+
+		__m128 x2 = _mm_add_ps(x, x), y2 = _mm_add_ps(y, y), z2 = _mm_add_ps(z, z);
+		__m128 xx = _mm_mul_ps(x, x2), yy = _mm_mul_ps(y, y2), zz = _mm_mul_ps(z, z2);
+		__m128 xy = _mm_mul_ps(x, y2), xz = _mm_mul_ps(x, z2), yz = _mm_mul_ps(y, z2);
+		__m128 wx = _mm_mul_ps(w, x2), wy = _mm_mul_ps(w, y2), wz = _mm_mul_ps(w, z2);
+
+		__m128 m[12];
+		m[0] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx);
+		m[1] = _mm_mul_ps(_mm_add_ps(xy, wz), sx);
+		m[2] = _mm_mul_ps(_mm_sub_ps(xz, wy), sx);
+		m[3] = _mm_mul_ps(_mm_sub_ps(xy, wz), sy);
+		m[4] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy);
+		m[5] = _mm_mul_ps(_mm_add_ps(yz, wx), sy);
+		m[6] = _mm_mul_ps(_mm_add_ps(xz, wy), sz);
+		m[7] = _mm_mul_ps(_mm_sub_ps(yz, wx), sz);
+		m[8] = _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz);
+		m[9] = _mm_load_ps(lanes.px);
+		m[10] = _mm_load_ps(lanes.py);
+		m[11] = _mm_load_ps(lanes.pz);
+
+		StoreMatrices(m, out, indices + i);
+	}
+
+	ComposeScalar(positions, rotations, scales, indices + i, count - i, out);
+}
+
+void TransformKernels::ComposeAVX2(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+	const uint32_t* indices, size_t count, glm::mat4* out)
+{
+	TRSLanes lanes;
+	const __m256 one = _mm256_set1_ps(1.0f);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		lanes.Gather(positions, rotations, scales, indices + i, 8);
+
+		__m256 x = _mm256_load_ps(lanes.qx), y = _mm256_load_ps(lanes.qy), z = _mm256_load_ps(lanes.qz), w = _mm256_load_ps(lanes.qw);
+		__m256 sx = _mm256_load_ps(lanes.sx), sy = _mm256_load_ps(lanes.sy), sz = _mm256_load_ps(lanes.sz);
+
+		__m256 x2 = _mm256_add_ps(x, x), y2 = _mm256_add_ps(y, y), z2 = _mm256_add_ps(z, z);
+		__m256 xx = _mm256_mul_ps(x, x2), yy = _mm256_mul_ps(y, y2), zz = _mm256_mul_ps(z, z2);
+		__m256 xy = _mm256_mul_ps(x, y2), xz = _mm256_mul_ps(x, z2), yz = _mm256_mul_ps(y, z2);
+		__m256 wx = _mm256_mul_ps(w, x2), wy = _mm256_mul_ps(w, y2), wz = _mm256_mul_ps(w, z2);
+
+		__m256 m[12];
+		m[0] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx);
+		m[1] = _mm256_mul_ps(_mm256_add_ps(xy, wz), sx);
+		m[2] = _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx);
+		m[3] = _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy);
+		m[4] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy);
+		m[5] = _mm256_mul_ps(_mm256_add_ps(yz, wx), sy);
+		m[6] = _mm256_mul_ps(_mm256_add_ps(xz, wy), sz);
+		m[7] = _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz);
+		m[8] = _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz);
+		m[9] = _mm256_load_ps(lanes.px);
+		m[10] = _mm256_load_ps(lanes.py);
+		m[11] = _mm256_load_ps(lanes.pz);
+
+		// Eight nodes wide for the math, stored four at a time like the SSE path
+		__m128 low[12], high[12];
+		for (int k = 0; k < 12; ++k)
+		{
+			low[k] = _mm256_castps256_ps128(m[k]);
+			high[k] = _mm256_extractf128_ps(m[k], 1);
+		}
+
+		StoreMatrices(low, out, indices + i);
+		StoreMatrices(high, out, indices + i + 4);
+	}
+
+	ComposeSSE(positions, rotations, scales, indices + i, count - i, out);
+}
+
+void TransformKernels::MultiplyScalar(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t index = indices[i];
+		int32_t parent = parents[index];
+		worlds[index] = parent >= 0 ? worlds[parent] * locals[index] : locals[index];
+	}
+}
+
+void TransformKernels::MultiplySSE(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t index = indices[i];
+		int32_t parent = parents[index];
+
+		const float* b = &locals[index][0][0];
+		float* result = &worlds[index][0][0];
+
+		if (parent < 0)
+		{
+			memcpy(result, b, sizeof(glm::mat4));
+			continue;
+		}
+
+		const float* a = &worlds[parent][0][0];
+		__m128 a0 = _mm_loadu_ps(a), a1 = _mm_loadu_ps(a + 4), a2 = _mm_loadu_ps(a + 8), a3 = _mm_loadu_ps(a + 12);
+
+		// Each result column is the parent's columns weighted by one local column
+		for (int column = 0; column < 4; ++column)
+		{
+			__m128 bc = _mm_loadu_ps(b + column * 4);
+			__m128 r = _mm_mul_ps(a0, _mm_shuffle_ps(bc, bc, 0x00));
+			r = _mm_add_ps(r, _mm_mul_ps(a1, _mm_shuffle_ps(bc, bc, 0x55)));
+			r = _mm_add_ps(r, _mm_mul_ps(a2, _mm_shuffle_ps(bc, bc, 0xAA)));
+			r = _mm_add_ps(r, _mm_mul_ps(a3, _mm_shuffle_ps(bc, bc, 0xFF)));
+			_mm_storeu_ps(result + column * 4, r);
+		}
+	}
+}
+
+void TransformKernels::MultiplyAVX2(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		uint32_t index = indices[i];
+		int32_t parent = parents[index];
+
+		const float* b = &locals[index][0][0];
+		float* result = &worlds[index][0][0];
+
+		if (parent < 0)
+		{
+			memcpy(result, b, sizeof(glm::mat4));
+			continue;
+		}
+
+		// Parent columns repeated in both halves, two local columns per register
+		const float* a = &worlds[parent][0][0];
+		__m256 a0 = _mm256_broadcast_ps((const __m128*)a);
+		__m256 a1 = _mm256_broadcast_ps((const __m128*)(a + 4));
+		__m256 a2 = _mm256_broadcast_ps((const __m128*)(a + 8));
+		__m256 a3 = _mm256_broadcast_ps((const __m128*)(a + 12));
+
+		for (int pair = 0; pair < 2; ++pair)
+		{
+			__m256 bc = _mm256_loadu_ps(b + pair * 8);
+			__m256 r = _mm256_mul_ps(a0, _mm256_permute_ps(bc, 0x00));
+			r = _mm256_fmadd_ps(a1, _mm256_permute_ps(bc, 0x55), r);
+			r = _mm256_fmadd_ps(a2, _mm256_permute_ps(bc, 0xAA), r);
+			r = _mm256_fmadd_ps(a3, _mm256_permute_ps(bc, 0xFF), r);
+			_mm256_storeu_ps(result + pair * 8, r);
+		}
+	}
+}
+
+void TransformKernels::RunBenchmark(int count)
+{
+	const int runs = 10;
+
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+	std::vector<glm::vec3> positions(count);
+	std::vector<glm::quat> rotations(count);
+	std::vector<glm::vec3> scales(count);
+	std::vector<int32_t> parents(count);
+	std::vector<uint32_t> indices(count);
+
+	// A four-way tree, every parent comes before its children like in TransformHierarchy
+	for (int i = 0; i < count; ++i)
+	{
+		positions[i] = glm::vec3(unit(random), unit(random), unit(random)) * 10.0f;
+		rotations[i] = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+		scales[i] = glm::vec3(1.0f) + glm::vec3(unit(random), unit(random), unit(random)) * 0.5f;
+		parents[i] = i > 0 ? (i - 1) / 4 : -1;
+		indices[i] = (uint32_t)i;
+	}
+
+	std::vector<glm::mat4> referenceLocals(count), referenceWorlds(count);
+	std::vector<glm::mat4> locals(count), worlds(count);
+
+	auto rate = [count, runs](double ms) { return ms > 0.0 ? count * (double)runs / (ms * 1000.0) : 0.0; };
+
+	Timer timer;
+	for (int run = 0; run < runs; ++run)
+	{
+		for (int i = 0; i < count; ++i)
+		{
+			glm::mat4 local = glm::translate(glm::mat4(1.0f), positions[i]);
+			local *= glm::mat4_cast(rotations[i]);
+			referenceLocals[i] = glm::scale(local, scales[i]);
+		}
+	}
+	double glmComposeMs = timer.ReadMs();
+
+	timer.Start();
+	for (int run = 0; run < runs; ++run)
+	{
+		for (int i = 0; i < count; ++i)
+			referenceWorlds[i] = parents[i] >= 0 ? referenceWorlds[parents[i]] * referenceLocals[i] : referenceLocals[i];
+	}
+	double glmMultiplyMs = timer.ReadMs();
+
+	LOG(LogType::LOG_INFO, "Transform kernels, %d nodes: glm compose %.1f M/s, multiply %.1f M/s",
+		count, rate(glmComposeMs), rate(glmMultiplyMs));
+
+	const SimdLevel previousLevel = GetLevel();
+
+	for (int level = 0; level <= (int)GetSupportedLevel(); ++level)
+	{
+		SetLevel((SimdLevel)level);
+
+		timer.Start();
+		for (int run = 0; run < runs; ++run)
+			ComposeTRS(positions.data(), rotations.data(), scales.data(), indices.data(), count, locals.data());
+		double composeMs = timer.ReadMs();
+
+		timer.Start();
+		for (int run = 0; run < runs; ++run)
+			MultiplyParent(locals.data(), parents.data(), indices.data(), count, worlds.data());
+		double multiplyMs = timer.ReadMs();
+
+		float maxError = 0.0f;
+		for (int i = 0; i < count; ++i)
+		{
+			for (int column = 0; column < 4; ++column)
+			{
+				glm::vec4 delta = glm::abs(worlds[i][column] - referenceWorlds[i][column]);
+				maxError = std::fmax(maxError, std::fmax(std::fmax(delta.x, delta.y), std::fmax(delta.z, delta.w)));
+			}
+		}
+
+		LOG(LogType::LOG_INFO, "Transform kernels, %s: compose %.1f M/s (%.2fx), multiply %.1f M/s (%.2fx), max error %g",
+			GetLevelName((SimdLevel)level), rate(composeMs), composeMs > 0.0 ? glmComposeMs / composeMs : 0.0,
+			rate(multiplyMs), multiplyMs > 0.0 ? glmMultiplyMs / multiplyMs : 0.0, maxError);
+	}
+
+	SetLevel(previousLevel);
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "glm/glm.hpp"
+#include "glm/gtc/quaternion.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+enum class SimdLevel : uint8_t
+{
+	SCALAR,
+	SSE,
+	AVX2,
+	COUNT
+};
+
+// Batched transform math over index lists. The level is picked from the CPU on first use and can be
+// lowered for comparison, every level gives the same results up to float rounding
+class TransformKernels
+{
+public:
+	static SimdLevel GetSupportedLevel();
+	static SimdLevel GetLevel();
+	// Capped to what the CPU supports
+	static void SetLevel(SimdLevel level);
+	static const char* GetLevelName(SimdLevel level);
+
+	// out[indices[i]] = translate(positions) * rotate(rotations) * scale(scales), all indexed by indices[i]
+	static void ComposeTRS(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count, glm::mat4* out);
+
+	// worlds[i] = worlds[parents[i]] * locals[i] for i in indices, in order, so a parent listed
+	// earlier is already updated when its children are reached. Roots (parent -1) copy their local
+	static void MultiplyParent(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds);
+
+	// Logs matrices per second of every supported level against plain glm over count random nodes
+	static void RunBenchmark(int count);
+
+private:
+	static void ComposeScalar(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count, glm::mat4* out);
+	static void ComposeSSE(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count, glm::mat4* out);
+	static void ComposeAVX2(const glm::vec3* positions, const glm::quat* rotations, const glm::vec3* scales,
+		const uint32_t* indices, size_t count, glm::mat4* out);
+
+	static void MultiplyScalar(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds);
+	static void MultiplySSE(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds);
+	static void MultiplyAVX2(const glm::mat4* locals, const int32_t* parents, const uint32_t* indices, size_t count, glm::mat4* worlds);
+};
\ No newline at end of file